@@ -1,5 +1,6 @@
-from .main import pd_code_diagram_sanity
-from .to_image import diagram_to_image, diagram_to_png
+from .compact import CompactDiagram
+from .main import pd_code_diagram_sanity, pd_code_layout_verify
+from .to_image import diagram_to_image, diagram_to_png, diagram_to_png_streaming
 
 
 def get_diagram_from_pd_code(*args, **kwargs):
@@ -14,16 +15,39 @@ def get_diagram_str_from_pd_code(*args, **kwargs):
     return func(*args, **kwargs)
 
 
+def get_svg_from_pd_code(*args, **kwargs):
+    from .main import get_svg_from_pd_code as func
+
+    return func(*args, **kwargs)
+
+
 def diagram_to_pd_code(*args, **kwargs):
-    from .from_diagram import diagram_to_pd_code as func
+    from .main import get_pd_code_from_diagram as func
+
+    return func(*args, **kwargs)
+
+def generate_pd_codes(*args, **kwargs):
+    from .main import generate_pd_codes as func
+
+    return func(*args, **kwargs)
+
+
+def random_pd_code(*args, **kwargs):
+    from .main import random_pd_code as func
 
     return func(*args, **kwargs)
 
 __all__ = [
+    "CompactDiagram",
     "get_diagram_from_pd_code",
     "get_diagram_str_from_pd_code",
+    "get_svg_from_pd_code",
     "diagram_to_pd_code",
+    "generate_pd_codes",
+    "random_pd_code",
     "diagram_to_image",
     "diagram_to_png",
-    "pd_code_diagram_sanity"
+    "diagram_to_png_streaming",
+    "pd_code_diagram_sanity",
+    "pd_code_layout_verify",
 ]
@@ -0,0 +1,144 @@
+"""A routed matrix stored in one flat integer buffer."""
+
+from __future__ import annotations
+
+from array import array
+import struct
+import sys
+from typing import Callable, Iterable, Iterator
+
+
+class CompactDiagram:
+    """Row-major diagram backed by a single ``array('h')`` (or ``array('i')``).
+
+    ``diagram[i]`` returns a zero-copy ``memoryview`` of row ``i``, so code
+    written for ``list[list[int]]`` can index ``diagram[i][j]`` and iterate
+    rows unchanged. ``view()`` (and ``memoryview(diagram)`` on Python 3.12+)
+    exposes the whole buffer with shape ``(rows, cols)``; ``tolist()`` converts
+    back to nested lists.
+    """
+
+    __slots__ = ("_rows", "_cols", "_data")
+
+    def __init__(self, rows: int, cols: int, data: array) -> None:
+        if rows <= 0 or cols <= 0:
+            raise ValueError("diagram must have at least one row and one column")
+        if data.typecode not in ("h", "i"):
+            raise TypeError("diagram data must be array('h') or array('i')")
+        if len(data) != rows * cols:
+            raise ValueError("diagram data does not match its shape")
+        self._rows = rows
+        self._cols = cols
+        self._data = data
+
+    @staticmethod
+    def _pack(values: Callable[[], Iterable[int]]) -> array:
+        # 16-bit cells cover every realistic label; wider ones fall back to 'i'.
+        try:
+            return array("h", values())
+        except OverflowError:
+            return array("i", values())
+
+    @classmethod
+    def from_rows(cls, diagram: Iterable[Iterable[int]]) -> CompactDiagram:
+        rows = [list(row) for row in diagram]
+        if not rows or not rows[0]:
+            raise ValueError("diagram must be a non-empty list of rows")
+        cols = len(rows[0])
+        if any(len(row) != cols for row in rows):
+            raise ValueError("diagram must be rectangular")
+        return cls(len(rows), cols, cls._pack(lambda: (value for row in rows for value in row)))
+
+    @classmethod
+    def from_bytes(cls, payload: bytes) -> CompactDiagram:
+        """Load the engine's ``--binary`` output without parsing any integers.
+
+        The layout is ``b"PDDG"``, then rows, cols and the cell size (2 or 4)
+        as little-endian uint32, then the cells row by row.
+        """
+
+        header = struct.Struct("<4sIII")
+        if len(payload) < header.size:
+            raise ValueError("truncated matrix header")
+        magic, rows, cols, cell_bytes = header.unpack_from(payload)
+        if magic != b"PDDG" or cell_bytes not in (2, 4):
+            raise ValueError("not a binary diagram")
+        data = array("h" if cell_bytes == 2 else "i")
+        if data.itemsize != cell_bytes:
+            raise ValueError(f"no {cell_bytes}-byte array type on this platform")
+        body = memoryview(payload)[header.size :]
+        if len(body) != rows * cols * cell_bytes:
+            raise ValueError("matrix size does not match its header")
+        data.frombytes(body)
+        if sys.byteorder == "big":
+            data.byteswap()
+        return cls(rows, cols, data)
+
+    @classmethod
+    def from_text(cls, text: str) -> CompactDiagram:
+        """Parse the engine's whitespace-separated matrix without per-row lists."""
+
+        lines = [line for line in text.splitlines() if line.strip()]
+        if not lines:
+            raise ValueError("empty matrix")
+        cols = len(lines[0].split())
+        tokens = text.split()
+        data = cls._pack(lambda: map(int, tokens))
+        if cols == 0 or len(data) != len(lines) * cols:
+            raise ValueError("ragged matrix")
+        return cls(len(lines), cols, data)
+
+    @property
+    def shape(self) -> tuple[int, int]:
+        return self._rows, self._cols
+
+    @property
+    def data(self) -> array:
+        return self._data
+
+    def __len__(self) -> int:
+        return self._rows
+
+    def __getitem__(self, i: int) -> memoryview:
+        if i < 0:
+            i += self._rows
+        if not 0 <= i < self._rows:
+            raise IndexError("diagram row index out of range")
+        start = i * self._cols
+        return memoryview(self._data)[start : start + self._cols]
+
+    def __iter__(self) -> Iterator[memoryview]:
+        view = memoryview(self._data)
+        for start in range(0, len(self._data), self._cols):
+            yield view[start : start + self._cols]
+
+    def view(self) -> memoryview:
+        """Return the whole buffer as a 2-D memoryview."""
+
+        return memoryview(self._data).cast("B").cast(self._data.typecode, self.shape)
+
+    def __buffer__(self, flags: int) -> memoryview:
+        return self.view()
+
+    def tolist(self) -> list[list[int]]:
+        values = self._data.tolist()
+        return [values[start : start + self._cols] for start in range(0, len(values), self._cols)]
+
+    def to_text(self) -> str:
+        """Format the matrix the way the engine reads it from stdin."""
+
+        values = [str(value) for value in self._data]
+        return "".join(
+            " ".join(values[start : start + self._cols]) + "\n"
+            for start in range(0, len(values), self._cols)
+        )
+
+    def __eq__(self, other: object) -> bool:
+        if isinstance(other, CompactDiagram):
+            return self.shape == other.shape and self._data == other._data
+        if isinstance(other, list):
+            return self.tolist() == other
+        return NotImplemented
+
+    def __repr__(self) -> str:
+        return f"CompactDiagram(rows={self._rows}, cols={self._cols}, typecode={self._data.typecode!r})"
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Generate/BraidDiagram.h"
+#include "../Generate/PdCodeGenerator.h"
+#include "../Utils/MyAssert.h"
+
+// 基准测试使用的 PD code 语料库
+// 所有输入都在程序中按固定规则生成，不依赖外部文件，保证每次运行的输入完全一致
+
+struct CorpusEntry {
+    std::string name;
+    std::string family;
+    int crossings;
+    int components;
+    std::string pd_code; // 与引擎标准输入相同的文本格式
+};
+
+class Corpus {
+private:
+    std::vector<CorpusEntry> entries;
+
+    void add(const std::string& name, const std::string& family, const BraidDiagram& diagram) {
+        std::vector<std::vector<int>> pd_code;
+        int component_cnt = 0;
+        bool ok = diagram.toPdCode(pd_code, component_cnt);
+        ASSERT(ok);
+        std::string text;
+        PdCodeGenerator::appendJson(text, pd_code);
+        entries.push_back(CorpusEntry{name, family, (int)pd_code.size(), component_cnt, text});
+    }
+
+    // 环面扭结（链环）T(p, q) = (s_1 s_2 ... s_{p-1})^q
+    static BraidDiagram torus(int p, int q) {
+        std::vector<BraidDiagram::Generator> gens;
+        for(int r = 0; r < q; r += 1) {
+            for(int j = 0; j + 1 < p; j += 1) {
+                gens.push_back({j, 1});
+            }
+        }
+        return BraidDiagram(p, gens);
+    }
+
+    // 椒盐卷饼链环 P(t_1, ..., t_k)：第 i 列在位置 2i 与 2i + 1 之间扭转 |t_i| 次
+    // 相邻两列的顶端（底端）用帽子连接，最左和最右的位置从外侧连接
+    static BraidDiagram pretzel(const std::vector<int>& twists) {
+        int k = (int)twists.size();
+        std::vector<BraidDiagram::Generator> gens;
+        for(int i = 0; i < k; i += 1) {
+            for(int r = 0; r < std::abs(twists[i]); r += 1) {
+                gens.push_back({2 * i, twists[i] > 0 ? 1 : -1});
+            }
+        }
+        std::vector<std::pair<int, int>> caps = {{0, 2 * k - 1}};
+        for(int i = 0; i + 1 < k; i += 1) {
+            caps.push_back({2 * i + 1, 2 * i + 2});
+        }
+        return BraidDiagram(2 * k, gens, caps, caps);
+    }
+
+public:
+    // 构造固定的语料库，seed 只影响随机交错扭结
+    explicit Corpus(unsigned int seed = 20240601) {
+        for(auto [p, q]: std::vector<std::pair<int, int>>{
+            {2, 3}, {2, 5}, {2, 7}, {3, 4}, {3, 5}, {2, 11}, {3, 7}, {4, 5}, {3, 10}, {5, 6}}) {
+            add("torus_" + std::to_string(p) + "_" + std::to_string(q), "torus", torus(p, q));
+        }
+
+        for(auto twists: std::vector<std::vector<int>>{
+            {3, 3, 3}, {-2, 3, 7}, {3, 5, 7}, {5, -3, 5, -3}, {3, 3, 3, 3, 3}}) {
+            std::string name = "pretzel";
+            for(int t: twists) name += "_" + std::to_string(t);
+            add(name, "pretzel", pretzel(twists));
+        }
+
+        std::mt19937 rng(seed);
+        for(int crossings: {3, 5, 8, 12, 20, 30, 50, 80, 120, 160, 200}) {
+            add("alternating_" + std::to_string(crossings), "alternating",
+                PdCodeGenerator::randomBraid(crossings, 1, true, rng));
+        }
+
+        add("hopf", "link", torus(2, 2));
+        add("torus_link_2_6", "link", torus(2, 6));
+        add("torus_link_3_3", "link", torus(3, 3));
+        add("borromean", "link", BraidDiagram(3, {{0, 1}, {1, -1}, {0, 1}, {1, -1}, {0, 1}, {1, -1}}));
+        add("pretzel_2_2_2", "link", pretzel({2, 2, 2}));
+        for(auto [crossings, components]: std::vector<std::pair<int, int>>{{24, 2}, {40, 3}, {80, 2}}) {
+            add("alternating_link_" + std::to_string(crossings) + "_" + std::to_string(components), "link",
+                PdCodeGenerator::randomBraid(crossings, components, true, rng));
+        }
+    }
+
+    const std::vector<CorpusEntry>& getEntries() const {
+        return entries;
+    }
+};
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../PathEngine/Common/Coord2dSet.h"
+#include "../PathEngine/Common/GraphWorkload.h"
+#include "../PathEngine/Common/LineData.h"
+#include "../PathEngine/GraphEngine/PixelGraphEngine.h"
+#include "../PathEngine/GraphEngine/VectorGraphEngine.h"
+#include "../PathEngine/GraphEngineWrap/ErasePointGraphEngineWrap.h"
+#include "../PathEngine/GraphEngineWrap/MarginGraphEngineWrap.h"
+#include "../PathEngine/GraphEngineWrap/MergeGraphEngineWrap.h"
+#include "../PathEngine/GraphEngineWrap/SpanGraphEngineWrap.h"
+
+// 重放 GraphWorkload 时使用的底层地图：与 LinkAlgo 相同，分为树边与交叉点两层
+// 新的地图实现只需要实现这个接口并加入 getReplayBackends，就可以与已有实现对比结果与速度
+class ReplayBackend {
+public:
+    virtual ~ReplayBackend(){}
+
+    // 两层都清空
+    virtual void reset() = 0;
+
+    virtual void setLine(WorkloadLayer layer, const LineData& line) = 0;
+
+    // 与 LinkAlgo::rawParsify 相同：两层所有线段端点的坐标合并为一个集合，再把坐标映射为 k 倍排名
+    virtual void commitCoordMap(int k) = 0;
+
+    virtual const AbstractGraphEngine& getLayer(WorkloadLayer layer) const = 0;
+};
+
+// VectorGraphEngine 自带坐标映射
+class VectorReplayBackend: public ReplayBackend {
+private:
+    VectorGraphEngine layers[2];
+
+public:
+    void reset() override {
+        layers[0] = VectorGraphEngine();
+        layers[1] = VectorGraphEngine();
+    }
+
+    void setLine(WorkloadLayer layer, const LineData& line) override {
+        layers[(int)layer].setLine(line);
+    }
+
+    void commitCoordMap(int k) override {
+        auto c2dsm = Coord2dSet::merge(layers[0].getCoord2dSet(), layers[1].getCoord2dSet());
+        layers[0].commitCoordMap(c2dsm, k);
+        layers[1].commitCoordMap(c2dsm, k);
+    }
+
+    const AbstractGraphEngine& getLayer(WorkloadLayer layer) const override {
+        return layers[(int)layer];
+    }
+};
+
+// 没有坐标映射的地图：记录写入过的线段，映射时用映射后的线段重新构建
+template<typename Engine>
+class RebuildReplayBackend: public ReplayBackend {
+private:
+    Engine layers[2];
+    std::vector<LineData> lines[2];
+
+public:
+    void reset() override {
+        for(int i = 0; i < 2; i += 1) {
+            layers[i] = Engine();
+            lines[i].clear();
+        }
+    }
+
+    void setLine(WorkloadLayer layer, const LineData& line) override {
+        lines[(int)layer].push_back(line);
+        layers[(int)layer].setLine(line);
+    }
+
+    void commitCoordMap(int k) override {
+        Coord2dSet c2dsm;
+        for(const auto& layer_lines: lines) {
+            for(const auto& line: layer_lines) {
+                c2dsm.addPos(line.getXf(), line.getYf());
+                c2dsm.addPos(line.getXt(), line.getYt());
+            }
+        }
+        for(int i = 0; i < 2; i += 1) {
+            layers[i] = Engine();
+            for(auto& line: lines[i]) {
+                line = LineData(
+                    c2dsm.xkRank(line.getXf(), k), c2dsm.xkRank(line.getXt(), k),
+                    c2dsm.ykRank(line.getYf(), k), c2dsm.ykRank(line.getYt(), k), line.getV());
+                layers[i].setLine(line);
+            }
+        }
+    }
+
+    const AbstractGraphEngine& getLayer(WorkloadLayer layer) const override {
+        return layers[(int)layer];
+    }
+};
+
+struct ReplayBackendFactory {
+    std::string name;
+    std::function<std::unique_ptr<ReplayBackend>()> make;
+};
+
+// 所有参与对比的地图实现，第一个作为基准
+inline std::vector<ReplayBackendFactory> getReplayBackends() {
+    return {
+        {"vector", []() {return std::unique_ptr<ReplayBackend>(new VectorReplayBackend());}},
+        {"pixel",  []() {return std::unique_ptr<ReplayBackend>(new RebuildReplayBackend<PixelGraphEngine>());}},
+    };
+}
+
+// 一种调用在一层地图上的统计
+struct ReplayOpStats {
+    uint64_t ops = 0;
+    double ns = 0;
+    uint64_t checksum = 14695981039346656037ull; // 所有返回值的 FNV-1a 哈希，不同实现之间必须相同
+    uint64_t mismatches = 0;                      // 与记录下来的返回值不同的次数
+
+    void mix(int64_t v) {
+        checksum = (checksum ^ (uint64_t)v) * 1099511628211ull;
+    }
+};
+
+// 键为 (调用名, 地图名)，例如 ("get_pos", "margin")
+using ReplayStats = std::map<std::pair<std::string, std::string>, ReplayOpStats>;
+
+class WorkloadReplay {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const std::vector<int32_t>& data;
+    size_t at = 0;
+    ReplayBackend& backend;
+    ReplayStats& stats;
+
+    int32_t next() {
+        if(at >= data.size()) {
+            throw std::runtime_error("graph workload ends in the middle of a record");
+        }
+        return data[at++];
+    }
+
+    static double nsSince(Clock::time_point begin) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+    }
+
+    static const char* layerName(WorkloadLayer layer) {
+        return layer == WorkloadLayer::TREE ? "tree" : "crossing";
+    }
+
+    std::tuple<int, int, int, int> nextBorder() {
+        int xmin = next(), xmax = next(), ymin = next(), ymax = next();
+        return std::make_tuple(xmin, xmax, ymin, ymax);
+    }
+
+    void mixBorder(ReplayOpStats& s, const std::tuple<int, int, int, int>& border) {
+        s.mix(std::get<0>(border)); s.mix(std::get<1>(border));
+        s.mix(std::get<2>(border)); s.mix(std::get<3>(border));
+    }
+
+    // 在一层地图上依次执行所有查询，只有 expect 为 true 时才与记录的返回值比较
+    void replayQueries(const char* engine, const AbstractGraphEngine& age, const int32_t* queries, int query_cnt, bool expect) {
+        auto& s = stats[{"get_pos", engine}];
+        auto begin = Clock::now();
+        for(int i = 0; i < query_cnt; i += 1) {
+            int v = age.getPos(queries[3 * i], queries[3 * i + 1]);
+            s.mix(v);
+            if(expect && v != queries[3 * i + 2]) s.mismatches += 1;
+        }
+        s.ns += nsSince(begin);
+        s.ops += query_cnt;
+    }
+
+    void replaySearch() {
+        const auto& tree = backend.getLayer(WorkloadLayer::TREE);
+        const auto& crossing = backend.getLayer(WorkloadLayer::CROSSING);
+
+        // 与 LinkAlgo::saveOne 相同的包装顺序
+        SpanGraphEngineWrap sgew(crossing);
+        MergeGraphEngineWrap megw(sgew, tree);
+        ErasePointGraphEngineWrap epgew(megw);
+        int erase_cnt = next();
+        for(int i = 0; i < erase_cnt; i += 1) {
+            int x = next(), y = next();
+            epgew.addEmptyPos(x, y);
+        }
+
+        auto border = nextBorder();
+        {
+            auto& s = stats[{"get_border", "erase_point"}];
+            auto begin = Clock::now();
+            auto got = epgew.getBorderCoord();
+            s.ns += nsSince(begin);
+            s.ops += 1;
+            mixBorder(s, got);
+            if(got != border) s.mismatches += 1;
+        }
+
+        int xmin = next(), xmax = next(), ymin = next(), ymax = next();
+        int xf = next(), yf = next(), xt = next(), yt = next();
+        bool blocked = (next() != 0);
+        int px = next(), py = next();
+        PixelGraphEngine single_point_graph;
+        if(blocked) {
+            single_point_graph.setPos(px, py, -3);
+        }
+        MergeGraphEngineWrap nmgew(single_point_graph, epgew);
+        const AbstractGraphEngine& view = blocked ? (const AbstractGraphEngine&)nmgew : epgew;
+        MarginGraphEngineWrap gew(view, xmin, xmax, ymin, ymax, -3, xf, yf, xt, yt);
+
+        int query_cnt = next();
+        if(at + 3 * (size_t)query_cnt > data.size()) {
+            throw std::runtime_error("graph workload ends in the middle of a record");
+        }
+        const int32_t* queries = data.data() + at;
+        at += 3 * (size_t)query_cnt;
+
+        // 每一层都重放同一串查询，外层包含内层的开销
+        replayQueries("tree",        tree,     queries, query_cnt, false);
+        replayQueries("crossing",    crossing, queries, query_cnt, false);
+        replayQueries("span",        sgew,     queries, query_cnt, false);
+        replayQueries("merge",       megw,     queries, query_cnt, false);
+        replayQueries("erase_point", epgew,    queries, query_cnt, !blocked);
+        replayQueries("margin",      gew,      queries, query_cnt, true);
+    }
+
+    void replayFinal() {
+        MergeGraphEngineWrap final_graph(
+            backend.getLayer(WorkloadLayer::CROSSING),
+            backend.getLayer(WorkloadLayer::TREE));
+
+        auto border = nextBorder();
+        {
+            auto& s = stats[{"get_border", "final"}];
+            auto begin = Clock::now();
+            auto got = final_graph.getBorderCoord();
+            s.ns += nsSince(begin);
+            s.ops += 1;
+            mixBorder(s, got);
+            if(got != border) s.mismatches += 1;
+        }
+
+        int neg_cnt = next();
+        std::vector<std::tuple<int, int>> neg_pos;
+        for(int i = 0; i < neg_cnt; i += 1) {
+            int x = next(), y = next();
+            neg_pos.push_back(std::make_tuple(x, y));
+        }
+        auto& s = stats[{"get_all_neg_pos", "final"}];
+        auto begin = Clock::now();
+        auto got = final_graph.getAllNegPos();
+        s.ns += nsSince(begin);
+        s.ops += 1;
+        for(auto [x, y]: got) {
+            s.mix(x); s.mix(y);
+        }
+        if(got != neg_pos) s.mismatches += 1;
+    }
+
+public:
+    WorkloadReplay(const GraphWorkload& workload, ReplayBackend& _backend, ReplayStats& _stats):
+        data(workload.getData()), backend(_backend), stats(_stats) {}
+
+    // 重放整个 workload，格式错误时抛出 std::runtime_error
+    void run() {
+        backend.reset();
+        at = 0;
+        while(at < data.size()) {
+            auto op = (WorkloadOp)next();
+            if(op == WorkloadOp::BEGIN_RUN) {
+                backend.reset();
+            }else if(op == WorkloadOp::SET_LINE) {
+                auto layer = (WorkloadLayer)next();
+                if(layer != WorkloadLayer::TREE && layer != WorkloadLayer::CROSSING) {
+                    throw std::runtime_error("graph workload has an unknown layer");
+                }
+                int xf = next(), xt = next(), yf = next(), yt = next(), v = next();
+                auto& s = stats[{"set_line", layerName(layer)}];
+                auto begin = Clock::now();
+                backend.setLine(layer, LineData(xf, xt, yf, yt, v));
+                s.ns += nsSince(begin);
+                s.ops += 1;
+            }else if(op == WorkloadOp::COMMIT_COORD_MAP) {
+                int k = next();
+                auto& s = stats[{"commit_coord_map", "both"}];
+                auto begin = Clock::now();
+                backend.commitCoordMap(k);
+                s.ns += nsSince(begin);
+                s.ops += 1;
+            }else if(op == WorkloadOp::SEARCH) {
+                replaySearch();
+            }else if(op == WorkloadOp::FINAL) {
+                replayFinal();
+            }else {
+                throw std::runtime_error("graph workload has an unknown record type");
+            }
+        }
+    }
+};
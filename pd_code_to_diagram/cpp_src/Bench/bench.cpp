@@ -0,0 +1,152 @@
+// 布局引擎的基准测试程序
+// 对程序内置的固定语料库逐个运行布局算法，每个输入输出一行 JSON
+//
+// 在 cpp_src 目录下编译：
+//   g++ -std=c++17 -O2 Bench/bench.cpp -o bench
+//
+// 参数：
+//   --filter TEXT        只运行名字中包含 TEXT 的输入
+//   --max-crossings N    跳过交叉点个数超过 N 的输入
+//   --repeat N           每个输入重复运行 N 次，报告最小值与中位数
+//   --list               只输出语料库本身（包括 pd_code），不运行布局
+
+#ifdef DEBUG
+    #if DEBUG
+        #undef DEBUG
+        #define DEBUG (1)
+    #else
+        #undef DEBUG
+        #define DEBUG (0)
+    #endif
+#else
+    #define DEBUG (0)
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Corpus.h"
+#include "../PdToDiagram2d.h"
+#include "../Utils/AllocHooks.h"
+#include "../Utils/AllocStats.h"
+#include "../Utils/PrecisionTimer.h"
+#include "../Utils/ResourceUsage.h"
+
+// 单次运行的结果
+struct BenchRun {
+    bool ok = false;
+    double wall_ms = 0;
+    int seeds_tried = 0;
+    int rows = 0;
+    int cols = 0;
+    long long peak_rss_kb = -1;
+    long long peak_heap_bytes = 0; // 运行期间新增的堆内存峰值，编译时引入 -DNO_ALLOC_STATS 时为 0
+    std::string error;
+};
+
+BenchRun runOnce(const CorpusEntry& entry, int max_try) {
+    BenchRun run;
+    ResourceUsage::resetPeakRss();
+    AllocStats::reset();
+    auto live_before = AllocStats::getLiveBytes();
+
+    std::stringstream ss(entry.pd_code);
+    PrecisionTimer timer;
+    timer.start();
+    try {
+        auto [link_algo, im] = PdToDiagram2d().convert(42, -1, ss, max_try, &run.seeds_tried);
+        run.ok   = true;
+        run.rows = im.getRowCnt();
+        run.cols = im.getColCnt();
+    }
+    PROCESS_EXCEPTION(MaxTryExceeded, run.error = "max try exceeded")
+    catch(const std::exception& e) {
+        run.error = e.what();
+    }
+    timer.stop();
+
+    run.wall_ms = timer.get_elapsed_ms();
+    run.peak_rss_kb = ResourceUsage::getPeakRssKb();
+    run.peak_heap_bytes = AllocStats::getPeakLiveBytes() - live_before;
+    return run;
+}
+
+std::string jsonString(const std::string& s) {
+    std::string ans = "\"";
+    for(char c: s) {
+        if(c == '"' || c == '\\') ans.push_back('\\');
+        if((unsigned char)c < 0x20) continue;
+        ans.push_back(c);
+    }
+    return ans + "\"";
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    int max_crossings = -1;
+    int repeat = 1;
+    bool list_only = false;
+
+    for(int i = 1; i < argc; i += 1) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--filter" && has_value) {
+            filter = argv[++i];
+        }else if(arg == "--max-crossings" && has_value && isAllDigits(argv[i + 1])) {
+            max_crossings = std::stoi(argv[++i]);
+        }else if(arg == "--repeat" && has_value && isAllDigits(argv[i + 1])) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        }else if(arg == "--list") {
+            list_only = true;
+        }else {
+            std::cerr << "error: invalid command line argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    const int max_try = 100; // 与 main.cpp 相同
+    Corpus corpus;
+    for(const auto& entry: corpus.getEntries()) {
+        if(!filter.empty() && entry.name.find(filter) == std::string::npos) continue;
+        if(max_crossings >= 0 && entry.crossings > max_crossings) continue;
+
+        std::cout << "{\"name\": " << jsonString(entry.name)
+                  << ", \"family\": " << jsonString(entry.family)
+                  << ", \"crossings\": " << entry.crossings
+                  << ", \"components\": " << entry.components;
+        if(list_only) {
+            std::cout << ", \"pd_code\": " << entry.pd_code << "}" << std::endl;
+            continue;
+        }
+
+        std::vector<BenchRun> runs;
+        for(int r = 0; r < repeat; r += 1) {
+            runs.push_back(runOnce(entry, max_try));
+        }
+        std::vector<double> times;
+        for(const auto& run: runs) times.push_back(run.wall_ms);
+        std::sort(times.begin(), times.end());
+
+        // 布局是确定性的，除了时间以外每次运行的结果都相同
+        const auto& run = runs.back();
+        std::cout << std::fixed << std::setprecision(3)
+                  << ", \"ok\": " << (run.ok ? "true" : "false")
+                  << ", \"wall_ms\": " << times[times.size() / 2]
+                  << ", \"wall_ms_min\": " << times.front()
+                  << ", \"repeat\": " << repeat
+                  << ", \"seeds_tried\": " << run.seeds_tried
+                  << ", \"rows\": " << run.rows
+                  << ", \"cols\": " << run.cols
+                  << ", \"peak_rss_kb\": " << run.peak_rss_kb
+                  << ", \"peak_heap_bytes\": " << run.peak_heap_bytes;
+        if(!run.ok) {
+            std::cout << ", \"error\": " << jsonString(run.error);
+        }
+        std::cout << "}" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+// 地图引擎的一致性检查与微基准测试
+// 记录 LinkAlgo 布线时对地图引擎的调用序列（GraphWorkload），再在每一种地图实现上重放：
+// 所有实现的返回值必须与记录一致并且彼此相同，同时给出每种调用的平均耗时
+//
+// 在 cpp_src 目录下编译：
+//   g++ -std=c++17 -O2 Bench/engine_bench.cpp -o engine_bench
+//
+// 参数：
+//   --filter TEXT        只记录名字中包含 TEXT 的语料
+//   --max-crossings N    跳过交叉点个数超过 N 的语料，默认 20
+//   --repeat N           每个实现重放 N 次，报告最快的一次，默认 3
+//   --backend NAME       只重放指定的实现，可以重复给出
+//   --workload FILE      不记录语料，改为重放 main --graph-workload 保存的文件，可以重复给出
+//   --save DIR           把记录下来的语料保存为 DIR/<name>.gwl
+//
+// 每个 workload、实现、调用与地图输出一行 JSON，每个 workload 最后输出一行汇总
+// 有任何不一致时返回 1
+
+#ifdef DEBUG
+    #if DEBUG
+        #undef DEBUG
+        #define DEBUG (1)
+    #else
+        #undef DEBUG
+        #define DEBUG (0)
+    #endif
+#else
+    #define DEBUG (0)
+#endif
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Corpus.h"
+#include "WorkloadReplay.h"
+#include "../PdToDiagram2d.h"
+
+struct NamedWorkload {
+    std::string name;
+    GraphWorkload workload;
+};
+
+// 运行一次完整的布局（包括失败的种子），记录其中所有 LinkAlgo 的调用
+GraphWorkload recordEntry(const CorpusEntry& entry) {
+    std::stringstream ss(entry.pd_code);
+    GraphWorkloadRecorder::enable();
+    try {
+        PdToDiagram2d().convert(42, -1, ss, 100);
+    }
+    PROCESS_EXCEPTION(MaxTryExceeded, ;)
+    GraphWorkloadRecorder::disable();
+    return GraphWorkloadRecorder::get();
+}
+
+std::string jsonString(const std::string& s) {
+    std::string ans = "\"";
+    for(char c: s) {
+        if(c == '"' || c == '\\') ans.push_back('\\');
+        if((unsigned char)c < 0x20) continue;
+        ans.push_back(c);
+    }
+    return ans + "\"";
+}
+
+std::string hex64(uint64_t v) {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << v;
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    int max_crossings = 20;
+    int repeat = 3;
+    std::vector<std::string> backend_names;
+    std::vector<std::string> workload_files;
+    std::string save_dir;
+
+    for(int i = 1; i < argc; i += 1) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--filter" && has_value) {
+            filter = argv[++i];
+        }else if(arg == "--max-crossings" && has_value && isAllDigits(argv[i + 1])) {
+            max_crossings = std::stoi(argv[++i]);
+        }else if(arg == "--repeat" && has_value && isAllDigits(argv[i + 1])) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        }else if(arg == "--backend" && has_value) {
+            backend_names.push_back(argv[++i]);
+        }else if(arg == "--workload" && has_value) {
+            workload_files.push_back(argv[++i]);
+        }else if(arg == "--save" && has_value) {
+            save_dir = argv[++i];
+        }else {
+            std::cerr << "error: invalid command line argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<ReplayBackendFactory> backends;
+    for(const auto& factory: getReplayBackends()) {
+        if(backend_names.empty() || std::find(backend_names.begin(), backend_names.end(), factory.name) != backend_names.end()) {
+            backends.push_back(factory);
+        }
+    }
+    if(backends.empty()) {
+        std::cerr << "error: no backend selected" << std::endl;
+        return 1;
+    }
+
+    std::vector<NamedWorkload> workloads;
+    try {
+        if(!workload_files.empty()) {
+            for(const auto& file: workload_files) {
+                workloads.push_back({std::filesystem::path(file).stem().string(), GraphWorkload::load(file)});
+            }
+        }else {
+            Corpus corpus;
+            for(const auto& entry: corpus.getEntries()) {
+                if(!filter.empty() && entry.name.find(filter) == std::string::npos) continue;
+                if(max_crossings >= 0 && entry.crossings > max_crossings) continue;
+                workloads.push_back({entry.name, recordEntry(entry)});
+            }
+        }
+        if(!save_dir.empty()) {
+            std::filesystem::create_directories(save_dir);
+            for(const auto& named: workloads) {
+                named.workload.save((std::filesystem::path(save_dir) / (named.name + ".gwl")).string());
+            }
+        }
+    }catch(const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    bool all_ok = true;
+    for(const auto& named: workloads) {
+        std::vector<ReplayStats> results;
+        try {
+            for(const auto& factory: backends) {
+                ReplayStats best;
+                for(int r = 0; r < repeat; r += 1) {
+                    auto backend = factory.make();
+                    ReplayStats stats;
+                    WorkloadReplay(named.workload, *backend, stats).run();
+                    if(r == 0) {
+                        best = stats;
+                        continue;
+                    }
+                    for(auto& [key, s]: best) { // 返回值每次都相同，只保留最快的耗时
+                        s.ns = std::min(s.ns, stats[key].ns);
+                    }
+                }
+                results.push_back(best);
+            }
+        }catch(const std::exception& e) {
+            std::cerr << "error: " << named.name << ": " << e.what() << std::endl;
+            return 1;
+        }
+
+        // 以第一个实现为基准比较校验和
+        uint64_t mismatches = 0;
+        bool identical = true;
+        for(size_t b = 0; b < backends.size(); b += 1) {
+            for(const auto& [key, s]: results[b]) {
+                const auto& base = results[0].at(key);
+                bool same = (s.checksum == base.checksum && s.ops == base.ops);
+                identical = identical && same;
+                mismatches += s.mismatches;
+                std::cout << std::fixed << std::setprecision(1)
+                          << "{\"workload\": " << jsonString(named.name)
+                          << ", \"backend\": " << jsonString(backends[b].name)
+                          << ", \"op\": " << jsonString(key.first)
+                          << ", \"engine\": " << jsonString(key.second)
+                          << ", \"ops\": " << s.ops
+                          << ", \"ns_per_op\": " << (s.ops == 0 ? 0.0 : s.ns / s.ops)
+                          << ", \"checksum\": \"" << hex64(s.checksum) << "\""
+                          << ", \"matches_" << backends[0].name << "\": " << (same ? "true" : "false")
+                          << ", \"mismatches\": " << s.mismatches << "}" << std::endl;
+            }
+        }
+        bool ok = identical && mismatches == 0;
+        all_ok = all_ok && ok;
+        std::cout << "{\"workload\": " << jsonString(named.name)
+                  << ", \"backends\": " << backends.size()
+                  << ", \"int32s\": " << named.workload.getData().size()
+                  << ", \"identical\": " << (identical ? "true" : "false")
+                  << ", \"mismatches\": " << mismatches
+                  << ", \"ok\": " << (ok ? "true" : "false") << "}" << std::endl;
+    }
+    return all_ok ? 0 : 1;
+}
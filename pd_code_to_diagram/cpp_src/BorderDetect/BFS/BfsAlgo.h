@@ -10,7 +10,6 @@
 #include <queue>
 
 #include "../IntMatrix2/ZeroOneMatrix.h"
-#include "../IntMatrix2/BorderWrap.h"
 
 #include "../../Utils/MyAssert.h"
 #include "../../Utils/Debug.h"
@@ -26,10 +25,7 @@ public:
         // 用一个 vis 数组记录每一个位置是否被访问过
         auto vis = ZeroOneMatrix(graph.getRcnt(), graph.getCcnt());
 
-        // 1 表示障碍物，0 表示不是障碍物
-        // 在外围填充 1
-        auto new_graph = BorderWrap(1, 
-            std::make_shared<ZeroOneMatrix>(graph)); // 拷贝构造一个
+        // 1 表示障碍物，0 表示不是障碍物，矩阵外围视为障碍物
         ASSERT(graph.getPos(xpos, ypos) == 0); // 初始位置不能是障碍物
 
         // BFS 队列
@@ -56,8 +52,11 @@ public:
                         + std::to_string(nx) + ", " + std::to_string(ny) + ")");
 
                 // 不需要访问已经访问过或者是障碍物的节点
-                // 这里必须先判断 new_graph.getPos(nx, ny) 因为 vis.getPos(nx, ny) 没有边界安全
-                if(new_graph.getPos(nx, ny) || vis.getPos(nx, ny)) {
+                // 这里必须先判断是否出界，因为 graph.getPos 和 vis.getPos 都没有边界安全
+                if(nx < 0 || nx >= graph.getRcnt() || ny < 0 || ny >= graph.getCcnt()) {
+                    continue;
+                }
+                if(graph.getPos(nx, ny) || vis.getPos(nx, ny)) {
                     continue;
                 }
 
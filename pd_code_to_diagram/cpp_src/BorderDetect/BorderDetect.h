@@ -8,6 +8,7 @@
 #endif
 
 #include <set>
+#include <vector>
 
 #include "BFS/BfsAlgo.h"
 #include "DataInput/FileDataInput.h"
@@ -16,46 +17,36 @@
 #include "IntMatrix2/BorderMask.h"
 #include "IntMatrix2/ZeroOneMatrix.h"
 
+#include "../Utils/BitGrid.h"
+#include "../Utils/GridBuffer.h"
 #include "../Utils/MyAssert.h"
 #include "../Utils/Debug.h"
 
 class BorderDetect {
-private:
-    // 计算两个集合的交集
-    std::set<int> intersect(std::set<int> a, std::set<int> b) const {
-        std::set<int> ans;
-        for(auto item: a) {
-            if(b.find(item) != b.end()) {
-                ans.insert(item);
-            }
-        }
-        return ans;
-    }
-
 public:
 
     // 获取所有联通分支
-    virtual std::vector<std::set<int>> getAllCc(const IntMatrix2& imx) const {
+    virtual ComponentLabels getAllCc(const AbstractIntMatrix2& imx) const {
         auto dg = DiagramGraph(imx);
         auto cc_alg = ConnectedComponents(dg);
-        auto all_cc = cc_alg.getConnectedComponents();
-        return all_cc;
+        return cc_alg.getComponentLabels();
     }
 
     // 输出所有连通分支到一个 json 字符串
-    virtual std::string jsonifyAllCc(const std::vector<std::set<int>>& all_cc) const {
+    virtual std::string jsonifyAllCc(const ComponentLabels& all_cc) const {
         std::string json_string;
 
         bool first_line = true;
         json_string += "[\n";
-        for(const auto& cc: all_cc) {
+        for(int k = 0; k < all_cc.getComponentCnt(); k += 1) {
             if(first_line) {
                 first_line = false;
             }else {
                 json_string += ",\n";
             }
             bool first = true;
-            for(const auto& item: cc) {
+            for(const int* it = all_cc.begin(k); it != all_cc.end(k); ++it) {
+                int item = *it;
                 if(first) {
                     first = false;
                     json_string += "    [";
@@ -70,12 +61,63 @@ public:
         return json_string;
     }
 
+    // checkBorderMaxCC 的融合版本，在一次遍历中完成外部区域的洪水填充和边界编号的收集
+    // in_target[v] 非零表示编号 v 属于需要位于最外圈的连通分支（由 pd_code 预先计算）
+    // 与 checkBorderMaxCC 一样，要求左上角是空地
+    // 外部区域的边界就是与可达空地相邻的非零格子，一旦遇到目标连通分支的编号就立即返回
+    // 模板参数 Cell 是矩阵格子的整数类型，访问标记按位压缩存储
+    template<typename Cell>
+    bool checkBorderFused(GridView<const Cell> grid, const std::vector<char>& in_target) const {
+        const int rcnt = grid.getRcnt();
+        const int ccnt = grid.getCcnt();
+        ASSERT(rcnt > 0 && ccnt > 0);
+        ASSERT(grid.at(0, 0) == 0); // 初始位置不能是障碍物
+
+        std::vector<const Cell*> rows(rcnt);
+        for(int i = 0; i < rcnt; i += 1) {
+            rows[i] = grid.row(i);
+        }
+
+        // 按行优先编号的访问标记以及 DFS 栈
+        BitGrid vis(rcnt, ccnt);
+        std::vector<int> stk;
+        stk.push_back(0);
+        vis.setIndex(0);
+
+        const int dx[] = {1, -1, 0,  0};
+        const int dy[] = {0,  0, 1, -1};
+        const int target_size = (int)in_target.size();
+
+        while(!stk.empty()) {
+            int idx = stk.back(); stk.pop_back();
+            int x = idx / ccnt;
+            int y = idx % ccnt;
+            for(int d = 0; d < 4; d += 1) {
+                int nx = x + dx[d];
+                int ny = y + dy[d];
+                if(nx < 0 || nx >= rcnt || ny < 0 || ny >= ccnt) continue;
+
+                int val = rows[nx][ny];
+                if(val == 0) {
+                    int nidx = nx * ccnt + ny;
+                    if(!vis.testIndex(nidx)) {
+                        vis.setIndex(nidx);
+                        stk.push_back(nidx);
+                    }
+                }else if(0 < val && val < target_size && in_target[val]) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
     // 检查最大编号所在的连通分支是否在边界上
     // 这里的 IntMatrix 是一个二维的 int 矩阵
     // 你需要保证最外围的一圈元素都是零（空地）
     // last_socket_id = -1 则要求最大编号 socket 所在连通分支在最外圈
     // last_socket_id > 0 则要求 last_socket_id 所在连通分支在最外圈
-    virtual bool checkBorderMaxCC(int last_socket_id, const IntMatrix2& imx) const {
+    virtual bool checkBorderMaxCC(int last_socket_id, const AbstractIntMatrix2& imx) const {
 
         // 获取整个矩阵中的最大元素
         auto mxv = imx.getMax(); 
@@ -97,7 +139,7 @@ public:
 
         // 检索 0 区域的边界位置
         SHOW_CERTAIN_DEBUG_MESSAGE(DEBUG_BORDER_DETECT, "Solving Border");
-        auto border_pos_raw = BorderMask(std::make_shared<ZeroOneMatrix>(vis_mx), 0);
+        auto border_pos_raw = BorderMask(std::make_shared<ZeroOneMatrix>(std::move(vis_mx)), 0);
         auto border_pos     = ZeroOneMatrix(border_pos_raw);
 
         // 在原始数据矩阵中进行筛选
@@ -107,17 +149,10 @@ public:
         // 计算原图中的所有联通分支
         // all_cc 包含了所有的 connected component 对应的 std::set<int>
         SHOW_CERTAIN_DEBUG_MESSAGE(DEBUG_BORDER_DETECT, "Solving Connected Component");
-        auto dg = DiagramGraph(imx);
-        auto cc_alg = ConnectedComponents(dg);
-        auto all_cc = cc_alg.getConnectedComponents();
+        auto all_cc = getAllCc(imx);
 
         // 找到最后编号对应的连通分量
-        auto lastv_cc = std::set<int>();
-        for(const auto& cc: all_cc) {
-            if(cc.find(lastv) != cc.end()) {
-                lastv_cc = cc;
-            }
-        }
+        int lastv_label = all_cc.getLabel(lastv);
 
         // 检查最大联通分支是否是独立在外的
         // 如果最大联通分支是独立在外的，那么我们的算法
@@ -125,6 +160,14 @@ public:
         // 但是这一点需要进一步进行验证
         // 具体做法就是对所有 link 考虑将其所有联通分支 swap 成最大编号联通分支并生成扭结
         SHOW_CERTAIN_DEBUG_MESSAGE(DEBUG_BORDER_DETECT, "Checking Cover");
-        return intersect(lastv_cc, set_int).size() != 0;
+        if(lastv_label < 0) {
+            return false;
+        }
+        for(int item: set_int) {
+            if(all_cc.getLabel(item) == lastv_label) {
+                return true;
+            }
+        }
+        return false;
     }
 };
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "AbstractDataInput.h"
+#include "../../Utils/Exceptions.h"
 #include "../../Utils/MyAssert.h"
 
 class FileDataInput: public AbstractDataInput{
@@ -85,16 +86,24 @@ public:
     virtual ~FileDataInput() {}
     virtual IntMatrix2 loadMatrix(std::istream& in) const override {
         auto [row_cnt, vec] = count_non_empty_lines(in);
-        ASSERT(row_cnt > 0);
+        if(row_cnt <= 0) {
+            THROW_EXCEPTION(BadDiagramException, "empty diagram");
+        }
 
         auto col_cnt = count_non_blank_segments(vec[0]);
         auto int_matrix = IntMatrix2(row_cnt, col_cnt);
 
         for(int i = 0; i < row_cnt; i += 1) {
+            if(count_non_blank_segments(vec[i]) != col_cnt) {
+                THROW_EXCEPTION(BadDiagramException, "row " + std::to_string(i) + " has a different length");
+            }
             std::stringstream ss;
             ss << vec[i];
             for(int j = 0; j < col_cnt; j += 1) {
-                int v; ss >> v;
+                int v;
+                if(!(ss >> v)) {
+                    THROW_EXCEPTION(BadDiagramException, "row " + std::to_string(i) + " contains a non-integer value");
+                }
                 int_matrix.setPos(i, j, v);
             }
         }
@@ -16,5 +16,6 @@ public:
     virtual bool checkHasNode(int nodeId) const = 0;
 
     // 找到某个节点下一步能走到的所有节点
-    virtual std::vector<int> getNextNode(int nodeId) const = 0;
+    // 返回的引用在图被修改或销毁之前有效
+    virtual const std::vector<int>& getNextNode(int nodeId) const = 0;
 };
@@ -1,29 +1,90 @@
 #pragma once
 
-#include <iostream>
-
 #include <algorithm>
-#include <cstdlib>
-#include <memory>
+#include <set>
+#include <vector>
+
 #include "AbstractGraph.h"
+#include "../../Utils/MyAssert.h"
+
+// 连通分支的扁平表示
+// label[node] 是节点所在连通分支的编号（节点 0 不存在，记为 -1）
+// 第 k 个连通分支的所有节点存放在 members[offsets[k]] 到 members[offsets[k + 1] - 1] 中（CSR 格式）
+// 连通分支按照其中最小的节点编号排序，每个连通分支内部的节点也从小到大排列
+class ComponentLabels {
+private:
+    std::vector<int> label;
+    std::vector<int> offsets;
+    std::vector<int> members;
+
+public:
+    ComponentLabels(std::vector<int> _label, std::vector<int> _offsets, std::vector<int> _members):
+        label(std::move(_label)), offsets(std::move(_offsets)), members(std::move(_members)) {
+        ASSERT(!offsets.empty());
+    }
+
+    int getComponentCnt() const {
+        return (int)offsets.size() - 1;
+    }
+
+    int getMaxNodeId() const {
+        return (int)label.size() - 1;
+    }
+
+    // 节点所在连通分支的编号，不存在的节点返回 -1
+    int getLabel(int node) const {
+        if(node <= 0 || node >= (int)label.size()) {
+            return -1;
+        }
+        return label[node];
+    }
+
+    // 第 k 个连通分支的节点范围 [begin, end)
+    const int* begin(int k) const {
+        ASSERT(0 <= k && k < getComponentCnt());
+        return members.data() + offsets[k];
+    }
+    const int* end(int k) const {
+        ASSERT(0 <= k && k < getComponentCnt());
+        return members.data() + offsets[k + 1];
+    }
+    int size(int k) const {
+        return (int)(end(k) - begin(k));
+    }
+
+    // 转换为集合形式，仅用于兼容旧的调用方式
+    std::vector<std::set<int>> toSets() const {
+        std::vector<std::set<int>> ans;
+        for(int k = 0; k < getComponentCnt(); k += 1) {
+            ans.push_back(std::set<int>(begin(k), end(k)));
+        }
+        return ans;
+    }
+};
 
 // 给定一个图计算所有联通分量
+// 并查集使用按大小合并以及路径减半，查找过程不使用递归
 class ConnectedComponents {
 protected:
-    int* fa; // union find set
+    std::vector<int> fa;   // union find set
+    std::vector<int> sz;   // 以当前节点为根的集合大小
     int maxNodeId = 0;
 
     int find(int x) {
-        if(x == fa[x]) return x;
-        return fa[x] = find(fa[x]);
+        while(fa[x] != x) {
+            fa[x] = fa[fa[x]]; // 路径减半
+            x = fa[x];
+        }
+        return x;
     }
 
     void link(int x, int y) {
         int rx = find(x);
         int ry = find(y);
         if(rx != ry) {
-            if(rand() & 1) std::swap(rx, ry);
+            if(sz[rx] > sz[ry]) std::swap(rx, ry);
             fa[rx] = ry;
+            sz[ry] += sz[rx];
         }
     }
 
@@ -37,38 +98,49 @@ protected:
     }
 
 public:
-    virtual ~ConnectedComponents() {
-        delete[] fa;
-    }
+    virtual ~ConnectedComponents() {}
     ConnectedComponents(const AbstractGraph& ag): maxNodeId(ag.getMaxNodeId()) {
-        fa = new int[ag.getMaxNodeId() + 1];
-        for(int i = 1; i <= ag.getMaxNodeId(); i += 1) {
+        fa.resize(maxNodeId + 1);
+        sz.assign(maxNodeId + 1, 1);
+        for(int i = 0; i <= maxNodeId; i += 1) {
             fa[i] = i;
         }
         construct_all(ag);
     }
 
-    virtual std::vector<std::set<int>> getConnectedComponents() {
-
-        // 初始化集合
-        auto ans = std::vector<std::set<int>>();
-        while((int)ans.size() - 1 < maxNodeId) {
-            ans.push_back(std::set<int>());
-        }
+    // 计算扁平的连通分支编号以及 CSR 格式的成员列表
+    virtual ComponentLabels getComponentLabels() {
+        std::vector<int> label(maxNodeId + 1, -1);
+        std::vector<int> root_label(maxNodeId + 1, -1);
+        std::vector<int> offsets(1, 0);
 
-        // 枚举所有对象，加入对应的等价类
+        // 按节点编号从小到大分配连通分支编号，同时统计每个连通分支的大小
+        int component_cnt = 0;
         for(int i = 1; i <= maxNodeId; i += 1) {
             int root_i = find(i);
-            ans[root_i].insert(i);
+            if(root_label[root_i] == -1) {
+                root_label[root_i] = component_cnt;
+                component_cnt += 1;
+                offsets.push_back(0);
+            }
+            label[i] = root_label[root_i];
+            offsets[label[i] + 1] += 1;
+        }
+        for(int k = 0; k < component_cnt; k += 1) {
+            offsets[k + 1] += offsets[k];
         }
 
-        // 将所有非空对象整理出来
-        auto non_empty = std::vector<std::set<int>>();
+        // 计数排序，节点编号递增地写入，因此每个连通分支内部天然有序
+        std::vector<int> members(maxNodeId);
+        std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
         for(int i = 1; i <= maxNodeId; i += 1) {
-            if(ans[i].size() > 0) {
-                non_empty.push_back(ans[i]);
-            }
+            members[cursor[label[i]]] = i;
+            cursor[label[i]] += 1;
         }
-        return non_empty;
+        return ComponentLabels(std::move(label), std::move(offsets), std::move(members));
+    }
+
+    virtual std::vector<std::set<int>> getConnectedComponents() {
+        return getComponentLabels().toSets();
     }
 };
@@ -44,7 +44,7 @@ public:
     }
 
     // 找到某个节点下一步能走到的所有节点
-    virtual std::vector<int> getNextNode(int nodeId) const {
+    virtual const std::vector<int>& getNextNode(int nodeId) const override {
         return graph.getNextNode(nodeId);
     }
 };
@@ -49,7 +49,7 @@ public:
     }
 
     // 找到某个节点下一步能走到的所有节点
-    virtual std::vector<int> getNextNode(int nodeId) const override {
+    virtual const std::vector<int>& getNextNode(int nodeId) const override {
         ASSERT(checkHasNode(nodeId));
         return nextNode[nodeId];
     }
@@ -12,33 +12,39 @@
 #include <vector>
 
 #include "AbstractIntMatrix2.h"
+#include "IntMatrix2View.h"
 #include "../IntMap/AbstractIntMap.h"
 #include "../IntCombine/AbstractIntCombine.h"
+#include "../../Utils/GridBuffer.h"
+#include "../../Utils/GridKernels.h"
 #include "../../Utils/MyAssert.h"
 #include "../../Utils/Debug.h"
 
 class IntMatrix2: public AbstractIntMatrix2 {
 protected:
-    std::vector<std::vector<int>> matrix_data;
+    GridBuffer<int> matrix_data; // 行优先连续存储
     int rcnt, ccnt;
 
 public:
     virtual ~IntMatrix2() {}
 
-    IntMatrix2(int r, int c) {
+    IntMatrix2(int r, int c): matrix_data(r, c, 0) {
         rcnt = r;
         ccnt = c;
+    }
 
-        // create zero line
-        std::vector<int> zeros;
-        for(int i = 0; i < c; i += 1) {
-            zeros.push_back(0);
-        }
+    // 直接接管一块已经填好的内存
+    explicit IntMatrix2(GridBuffer<int>&& buffer): matrix_data(std::move(buffer)) {
+        rcnt = matrix_data.getRcnt();
+        ccnt = matrix_data.getCcnt();
+    }
 
-        // push zero line into matrix_data
-        for(int i = 0; i < r; i += 1) {
-            matrix_data.push_back(zeros);
-        }
+    // 只能移动，需要副本时使用 clone
+    IntMatrix2(IntMatrix2&&) = default;
+    IntMatrix2& operator=(IntMatrix2&&) = default;
+
+    IntMatrix2 clone() const {
+        return IntMatrix2(matrix_data.clone());
     }
 
     virtual int getRcnt() const override {
@@ -58,20 +64,31 @@ public:
                 + std::to_string(rcnt) + ", " + std::to_string(ccnt) + ")");
         }
         ASSERT(0 <= i && i < rcnt && 0 <= j && j < ccnt);
-        return matrix_data[i][j];
+        return matrix_data.at(i, j);
+    }
+    // 获取一行数据的起始地址，一行中的元素连续存储
+    const int* rowData(int i) const {
+        return matrix_data.row(i);
+    }
+
+    // 不拷贝数据的只读视图
+    GridView<const int> getGrid() const {
+        return matrix_data.view();
+    }
+    IntMatrix2View view() const {
+        return IntMatrix2View(matrix_data.view());
     }
+
     virtual void setPos(int i, int j, int v) {
         ASSERT(0 <= i && i < rcnt && 0 <= j && j < ccnt);
-        matrix_data[i][j] = v;
+        matrix_data.at(i, j) = v;
     }
 
     // 把矩阵中每一个值映射一次
     virtual void mapAll(const AbstractIntMap& int_map_func) {
-        for(int i = 0; i < rcnt; i += 1) {
-            for(int j = 0; j < ccnt; j += 1) {
-                matrix_data[i][j] = int_map_func.mapInt(i, j, matrix_data[i][j]);
-            }
-        }
+        gridkernels::gridMapAll(matrix_data.view(), [&](int i, int j, int v) {
+            return int_map_func.mapInt(i, j, v);
+        });
     }
 
     // 合并两个相同大小矩阵的值
@@ -80,22 +97,14 @@ public:
         ASSERT(getCcnt() == rhs.getCcnt());
 
         auto ans = IntMatrix2(rcnt, ccnt);
-        for(int i = 0; i < rcnt; i += 1) {
-            for(int j = 0; j < ccnt; j += 1) {
-                ans.setPos(i, j, aci.combineInt(i, j, getPos(i, j), rhs.getPos(i, j)));
-            }
-        }
+        gridkernels::gridCombine(getGrid(), rhs.getGrid(), ans.matrix_data.view(), [&](int i, int j, int a, int b) {
+            return aci.combineInt(i, j, a, b);
+        });
         return ans;
     }
 
     // 获取所有元素的最大值
-    virtual int getMax() const {
-        int ans = -2147482648;
-        for(int i = 0; i < getRcnt(); i += 1) {
-            for(int j = 0; j < getCcnt(); j += 1) {
-                ans = std::max(ans, getPos(i, j));
-            }
-        }
-        return ans;
+    virtual int getMax() const override {
+        return gridkernels::gridMax(getGrid());
     }
 };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+#include "AbstractIntMatrix2.h"
+#include "../../Utils/CellGrid.h"
+#include "../../Utils/GridBuffer.h"
+#include "../../Utils/GridKernels.h"
+#include "../../Utils/MyAssert.h"
+
+// 把一块连续存储的矩阵包装成 AbstractIntMatrix2，不拷贝任何数据
+// 底层格子可以是 int16_t 或者 int，由 CellWidth 区分
+// 视图不拥有内存，使用期间底层矩阵必须保持存活且不被移动
+class IntMatrix2View: public AbstractIntMatrix2 {
+private:
+    CellWidth width;
+    GridView<const int16_t> narrow;
+    GridView<const int> wide;
+
+public:
+    virtual ~IntMatrix2View() {}
+    explicit IntMatrix2View(GridView<const int16_t> grid):
+        width(CellWidth::NARROW), narrow(grid), wide(nullptr, 0, 0, 0) {}
+    explicit IntMatrix2View(GridView<const int> grid):
+        width(CellWidth::WIDE), narrow(nullptr, 0, 0, 0), wide(grid) {}
+
+    virtual int getRcnt() const override {
+        return width == CellWidth::NARROW ? narrow.getRcnt() : wide.getRcnt();
+    }
+    virtual int getCcnt() const override {
+        return width == CellWidth::NARROW ? narrow.getCcnt() : wide.getCcnt();
+    }
+
+    virtual int getPos(int i, int j) const override {
+        return width == CellWidth::NARROW ? narrow.at(i, j) : wide.at(i, j);
+    }
+
+    CellWidth getWidth() const {
+        return width;
+    }
+
+    // 以实际的格子类型调用 func(GridView<const Cell>)
+    template<typename Func>
+    decltype(auto) visit(Func&& func) const {
+        if(width == CellWidth::NARROW) {
+            return func(narrow);
+        }
+        return func(wide);
+    }
+
+    // 获取所有元素的最大值
+    virtual int getMax() const override {
+        return visit([](auto grid) {
+            return gridkernels::gridMax(grid);
+        });
+    }
+};
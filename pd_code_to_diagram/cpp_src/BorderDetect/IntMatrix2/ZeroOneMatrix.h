@@ -1,47 +1,90 @@
 #pragma once
 
+#include <algorithm>
 #include <set>
+#include <vector>
 
-#include "IntMatrix2.h"
-#include "../IntMap/NotIntMap.h"
+#include "AbstractIntMatrix2.h"
+#include "../../Utils/BitGrid.h"
 #include "../../Utils/MyAssert.h"
 
-class ZeroOneMatrix: public IntMatrix2 {
+// 只包含 0 和 1 的矩阵，每个格子按位存储
+class ZeroOneMatrix: public AbstractIntMatrix2 {
+protected:
+    BitGrid bits;
+
 public:
     virtual ~ZeroOneMatrix() {}
-    ZeroOneMatrix(int rcnt, int ccnt): IntMatrix2(rcnt, ccnt) {}
-    ZeroOneMatrix(const AbstractIntMatrix2& mat): IntMatrix2(mat.getRcnt(), mat.getCcnt()) {
-        for(int i = 0; i < rcnt; i += 1) {
-            for(int j = 0; j < ccnt; j += 1) {
-                setPos(i, j, mat.getPos(i, j) != 0);
+    ZeroOneMatrix(int rcnt, int ccnt): bits(rcnt, ccnt) {}
+    ZeroOneMatrix(const AbstractIntMatrix2& mat): bits(mat.getRcnt(), mat.getCcnt()) {
+        for(int i = 0; i < getRcnt(); i += 1) {
+            for(int j = 0; j < getCcnt(); j += 1) {
+                bits.set(i, j, mat.getPos(i, j) != 0);
             }
         }
     }
+    ZeroOneMatrix(ZeroOneMatrix&&) = default;
 
-    virtual void setPos(int i, int j, int v) override {
+    virtual int getRcnt() const override {
+        return bits.getRcnt();
+    }
+    virtual int getCcnt() const override {
+        return bits.getCcnt();
+    }
+
+    virtual void setPos(int i, int j, int v) {
         ASSERT(v == 0 || v == 1);
-        this -> IntMatrix2::setPos(i, j, v);
+        bits.set(i, j, v);
     }
 
     virtual int getPos(int i, int j) const override {
-        return this -> IntMatrix2::getPos(i, j) != 0;
+        return bits.get(i, j);
     }
 
     // 对所有位置的值域取反
     virtual void notAll() {
-        mapAll(NotIntMap());
+        bits.flipAll();
     }
 
     // 使用当前的 ZeroOneMatrix 
+    // 只访问值为 1 的位置，先收集到数组中，值域不大时用位图去重，否则排序去重
     virtual std::set<int> select(const AbstractIntMatrix2& mat) const {
-        std::set<int> ans;
-        for(int i = 0; i < getRcnt(); i += 1) {
-            for(int j = 0; j < getCcnt(); j += 1) {
-                if(getPos(i, j)) {
-                    ans.insert(mat.getPos(i, j));
-                }
+        std::vector<int> values;
+        const int ccnt = getCcnt();
+        bits.forEachSet([&](std::size_t idx) {
+            values.push_back(mat.getPos((int)(idx / ccnt), (int)(idx % ccnt)));
+        });
+        if(values.empty()) {
+            return std::set<int>();
+        }
+
+        auto [vmin, vmax] = std::minmax_element(values.begin(), values.end());
+        long long lo = *vmin, range = (long long)*vmax - *vmin + 1;
+        std::vector<int> labels;
+        if(range <= 4 * (long long)values.size() + 1024) {
+            std::vector<char> seen(range, 0);
+            for(int v: values) {
+                seen[v - lo] = 1;
             }
+            for(long long k = 0; k < range; k += 1) {
+                if(seen[k]) labels.push_back((int)(k + lo));
+            }
+        }else {
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            labels.swap(values);
+        }
+
+        // labels 已经有序，逐个插入到末尾只需要均摊常数时间
+        std::set<int> ans;
+        for(int v: labels) {
+            ans.insert(ans.end(), v);
         }
         return ans;
     }
+
+    // 获取所有元素的最大值
+    virtual int getMax() const override {
+        return bits.count() > 0 ? 1 : 0;
+    }
 };
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "../PathEngine/Common/LineData.h"
+#include "../Utils/Direction.h"
+#include "../Utils/MyAssert.h"
+
+// 稀疏边界检查的结果
+// UNKNOWN 表示无法在线段图上得出结论，需要退回到稠密矩阵上检查
+enum class OuterFaceResult {
+    PASS,
+    FAIL,
+    UNKNOWN
+};
+
+// 直接在 LinkAlgo 给出的线段图上判断目标连通分支是否位于最外圈
+// 所有线段都与坐标轴平行，且只在端点处相交，因此线段图本身就是一个平面嵌入
+// 从 x 最小（其次 y 最小）的顶点出发，沿着外部面走一圈，经过的所有边的编号就是边界上的编号
+// 外部面的计算代价只与线段数目有关，与栅格面积无关
+// 压缩之后所有坐标都是偶数，两条线之间至少隔着一格空地，所以这里得到的边界与栅格化后的边界一致
+class OuterFaceDetect {
+private:
+    struct Vertex {
+        int x, y;
+        int next [4]; // 四个方向上的相邻顶点，-1 表示没有
+        int label[4]; // 对应边的编号
+    };
+
+    static int dirDx(int d) {return d == (int)Direction::EAST  ? 1 : (d == (int)Direction::WEST  ? -1 : 0);}
+    static int dirDy(int d) {return d == (int)Direction::NORTH ? 1 : (d == (int)Direction::SOUTH ? -1 : 0);}
+
+    static int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+
+    static long long pointKey(int x, int y) {
+        return ((long long)x << 32) ^ (unsigned int)y;
+    }
+
+    // 建立平面图，每个顶点在每个方向上至多一条边，线段重叠时返回 false
+    static bool buildGraph(const std::vector<LineData>& edges, std::vector<Vertex>& vertices, int& edge_cnt) {
+        std::unordered_map<long long, int> vertex_id;
+        auto getVertex = [&](int x, int y) {
+            auto key = pointKey(x, y);
+            auto it = vertex_id.find(key);
+            if(it != vertex_id.end()) {
+                return it -> second;
+            }
+            Vertex vertex;
+            vertex.x = x;
+            vertex.y = y;
+            std::fill(vertex.next, vertex.next + 4, -1);
+            std::fill(vertex.label, vertex.label + 4, 0);
+            vertices.push_back(vertex);
+            vertex_id[key] = (int)vertices.size() - 1;
+            return (int)vertices.size() - 1;
+        };
+
+        edge_cnt = 0;
+        for(const auto& ld: edges) {
+            int dx = sign(ld.getXt() - ld.getXf());
+            int dy = sign(ld.getYt() - ld.getYf());
+            if(dx == 0 && dy == 0) continue; // 原地转向产生的零长度线段
+
+            int dir = 0;
+            while(dirDx(dir) != dx || dirDy(dir) != dy) dir += 1;
+
+            int u = getVertex(ld.getXf(), ld.getYf());
+            int v = getVertex(ld.getXt(), ld.getYt());
+            if(vertices[u].next[dir] != -1 || vertices[v].next[(dir + 2) % 4] != -1) {
+                return false; // 线段重叠，不是预期中的平面图
+            }
+            vertices[u].next[dir] = v;
+            vertices[u].label[dir] = ld.getV();
+            vertices[v].next[(dir + 2) % 4] = u;
+            vertices[v].label[(dir + 2) % 4] = ld.getV();
+            edge_cnt += 1;
+        }
+        return true;
+    }
+
+    enum class WalkResult {
+        FINISHED, // 走完了整个外部面
+        STOPPED,  // visit 要求提前结束
+        BROKEN    // 嵌入不符合预期
+    };
+
+    // 从 start 出发沿着它所在部分的外部面走一圈，start 必须是该部分中 x 最小（其次 y 最小）的顶点
+    // 每经过一条边调用一次 visit(from, to, label)，visit 返回 true 时提前结束
+    // 保持外部面在左手边行走：每到一个顶点，依次尝试左转、直行、右转、掉头
+    // 假装从南侧向北进入起点，此时左手边（西侧）就是外部面
+    template<typename Visit>
+    static WalkResult walkOuterFace(const std::vector<Vertex>& vertices, int start, int edge_cnt, Visit&& visit) {
+        int cur = start;
+        int dir_in = (int)Direction::NORTH;
+        int first_dir = -1;
+        for(int step = 0; step <= 2 * edge_cnt + 1; step += 1) {
+            int dir_out = -1;
+            for(int turn: {1, 0, 3, 2}) {
+                int d = (dir_in + turn) % 4;
+                if(vertices[cur].next[d] != -1) {
+                    dir_out = d;
+                    break;
+                }
+            }
+            if(dir_out == -1) {
+                return WalkResult::BROKEN; // 孤立点
+            }
+
+            // 回到起点并且准备走同一条边，说明外部面已经走完
+            if(cur == start && step > 0 && dir_out == first_dir) {
+                return WalkResult::FINISHED;
+            }
+            if(step == 0) {
+                first_dir = dir_out;
+            }
+
+            int nxt = vertices[cur].next[dir_out];
+            if(visit(cur, nxt, vertices[cur].label[dir_out])) {
+                return WalkResult::STOPPED;
+            }
+            cur = nxt;
+            dir_in = dir_out;
+        }
+        return WalkResult::BROKEN; // 没有回到起点
+    }
+
+    static bool lessPos(const Vertex& a, const Vertex& b) {
+        return std::make_tuple(a.x, a.y) < std::make_tuple(b.x, b.y);
+    }
+
+public:
+    // in_target[v] 非零表示编号 v 属于需要位于最外圈的连通分支
+    // component_cnt 是底图连通分支数目，多于一个时各部分可能互相嵌套，这里不做判断
+    static OuterFaceResult check(const std::vector<LineData>& edges, const std::vector<char>& in_target, int component_cnt) {
+        if(component_cnt != 1) {
+            return OuterFaceResult::UNKNOWN;
+        }
+
+        std::vector<Vertex> vertices;
+        int edge_cnt;
+        if(!buildGraph(edges, vertices, edge_cnt) || vertices.empty()) {
+            return OuterFaceResult::UNKNOWN;
+        }
+
+        // x 最小的顶点中 y 最小的那个一定在外部面上，它的西侧和南侧都没有边
+        int start = 0;
+        for(int i = 1; i < (int)vertices.size(); i += 1) {
+            if(lessPos(vertices[i], vertices[start])) {
+                start = i;
+            }
+        }
+
+        const int target_size = (int)in_target.size();
+        auto result = walkOuterFace(vertices, start, edge_cnt, [&](int, int, int label) {
+            return 0 < label && label < target_size && in_target[label];
+        });
+        switch(result) {
+            case WalkResult::STOPPED:  return OuterFaceResult::PASS;
+            case WalkResult::FINISHED: return OuterFaceResult::FAIL;
+            default:                   return OuterFaceResult::UNKNOWN;
+        }
+    }
+
+    // 计算所有与无界区域相邻的弧的编号，结果与 GetBorderSet 在导出矩阵上的结果一致
+    // 线段图可能有多个互不相交的部分，每个部分先沿自己的外部面走一圈，
+    // 再用一次扫描线判断它是否被另一个部分的外边界包围，只有不被包围的部分才与无界区域相邻
+    // 嵌入不符合预期时返回 false，此时调用者应退回到稠密矩阵上计算
+    static bool getBorderLabels(const std::vector<LineData>& edges, std::set<int>& labels) {
+        labels.clear();
+        std::vector<Vertex> vertices;
+        int edge_cnt;
+        if(!buildGraph(edges, vertices, edge_cnt)) {
+            return false;
+        }
+
+        // 划分线段图的各个部分，并找到每个部分中 x 最小（其次 y 最小）的顶点
+        const int vcnt = (int)vertices.size();
+        std::vector<int> part(vcnt, -1);
+        std::vector<int> part_start;
+        for(int i = 0; i < vcnt; i += 1) {
+            if(part[i] != -1) continue;
+            int pid = (int)part_start.size();
+            part_start.push_back(i);
+            std::vector<int> stk = {i};
+            part[i] = pid;
+            while(!stk.empty()) {
+                int cur = stk.back(); stk.pop_back();
+                if(lessPos(vertices[cur], vertices[part_start[pid]])) {
+                    part_start[pid] = cur;
+                }
+                for(int d = 0; d < 4; d += 1) {
+                    int nxt = vertices[cur].next[d];
+                    if(nxt != -1 && part[nxt] == -1) {
+                        part[nxt] = pid;
+                        stk.push_back(nxt);
+                    }
+                }
+            }
+        }
+
+        // 沿每个部分的外部面走一圈，记录经过的编号以及平行于 x 轴的边
+        // 外部面在左手边，向东走的边北侧是外部面、南侧在这个部分内部；桥边会被来回走两次，只保留一份
+        struct OutlineEdge {
+            int y, xmin, xmax, pid;
+            bool east, west; // 沿外部面行走时是否向东、向西经过这条边
+        };
+        const int pcnt = (int)part_start.size();
+        std::vector<OutlineEdge> outline;
+        std::vector<int> edge_from(vcnt, -1); // 以西侧端点为下标，每个顶点向东至多一条边
+        std::vector<std::set<int>> part_labels(pcnt);
+        for(int pid = 0; pid < pcnt; pid += 1) {
+            auto result = walkOuterFace(vertices, part_start[pid], edge_cnt, [&](int from, int to, int label) {
+                part_labels[pid].insert(label);
+                const auto& a = vertices[from];
+                const auto& b = vertices[to];
+                if(a.y == b.y) {
+                    int west_end = (a.x < b.x) ? from : to;
+                    if(edge_from[west_end] == -1) {
+                        edge_from[west_end] = (int)outline.size();
+                        outline.push_back({a.y, std::min(a.x, b.x), std::max(a.x, b.x), pid, false, false});
+                    }
+                    auto& edge = outline[edge_from[west_end]];
+                    (a.x < b.x ? edge.east : edge.west) = true;
+                }
+                return false;
+            });
+            if(result != WalkResult::FINISHED) {
+                return false;
+            }
+        }
+
+        // 测试点取在起点西南方向半格处，从测试点沿 y 正方向发出射线，只看射线碰到的第一条外边界
+        // 这条边向东走时测试点在它所属部分的内部，否则测试点与这个部分处在同一个面中，是否被包围与这个部分相同
+        // 被碰到的部分的起点 x 坐标严格更小，因此按 x 从小到大扫描时它的结果已经算好
+        // 坐标乘 2 之后线段端点都是偶数，测试点是奇数，同一位置上先删除再插入线段
+        // 总代价为 O((线段数 + 部分数) log 线段数)
+        std::vector<std::tuple<long long, int, int>> events; // 位置，类型（0 删除，1 插入，2 询问），下标
+        for(int i = 0; i < (int)outline.size(); i += 1) {
+            events.push_back(std::make_tuple(2LL * outline[i].xmin, 1, i));
+            events.push_back(std::make_tuple(2LL * outline[i].xmax, 0, i));
+        }
+        for(int pid = 0; pid < pcnt; pid += 1) {
+            events.push_back(std::make_tuple(2LL * vertices[part_start[pid]].x - 1, 2, pid));
+        }
+        std::sort(events.begin(), events.end());
+
+        std::map<int, int> active; // 与扫描线相交的边，按 y 坐标排序
+        std::vector<char> enclosed(pcnt, 0);
+        for(auto [pos, type, idx]: events) {
+            if(type == 0) {
+                active.erase(outline[idx].y);
+            }else if(type == 1) {
+                if(!active.emplace(outline[idx].y, idx).second) {
+                    return false; // 线段重叠，不是预期中的平面图
+                }
+            }else {
+                auto it = active.lower_bound(vertices[part_start[idx]].y);
+                if(it != active.end()) {
+                    const auto& edge = outline[it -> second];
+                    enclosed[idx] = (edge.east && !edge.west) ? 1 : enclosed[edge.pid];
+                }
+            }
+        }
+
+        for(int pid = 0; pid < pcnt; pid += 1) {
+            if(!enclosed[pid]) {
+                labels.insert(part_labels[pid].begin(), part_labels[pid].end());
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../LinkAlgo.h"
+
+// 输出每个交叉点的定向信息，使下游无需推断方向就可以直接读出 pd_code
+// 坐标与 exportToIntMatrix 导出的矩阵一致（行、列）
+// 方向编号与 from_diagram.py 中的 DX, DY 一致：0 右，1 上，2 左，3 下（逆时针）
+// sockets[k] 位于 base_direction 逆时针旋转 k 次的方向上，因此 sockets 就是这个交叉点的 pd_code 记录
+class CrossingMetadata {
+private:
+    struct CrossingInfo {
+        int row, col;
+        int value;          // -1 或者 -2，与矩阵中的值相同
+        int base_direction; // 从下方进入交叉点的 socket 所在的方向
+        std::vector<int> sockets;
+    };
+
+    int rcnt, ccnt;
+    std::vector<CrossingInfo> crossings;
+
+    // 引擎方向 E, N, W, S 在矩阵中分别是下、右、上、左
+    static int screenDirection(Direction dir) {
+        return ((int)dir + 3) % 4;
+    }
+
+public:
+    explicit CrossingMetadata(LinkAlgo& link_algo) {
+        auto final_graph = link_algo.getFinalGraph();
+        int xmin, xmax, ymin, ymax;
+        std::tie(xmin, xmax, ymin, ymax) = final_graph.getBorderCoord();
+        rcnt = xmax - xmin + 3;
+        ccnt = ymax - ymin + 3;
+
+        const auto& socket_info = link_algo.getSocketInfo();
+        for(const auto& [pos, sockets]: socket_info.getCrossingRecords()) {
+            auto [x, y] = pos;
+            CrossingInfo info;
+            info.row = x - (xmin - 1);
+            info.col = y - (ymin - 1);
+            info.value = final_graph.getPos(x, y);
+            info.base_direction = screenDirection(socket_info.getBaseDirection(x, y));
+            info.sockets = sockets;
+            crossings.push_back(info);
+        }
+        std::sort(crossings.begin(), crossings.end(), [](const CrossingInfo& a, const CrossingInfo& b) {
+            return std::make_tuple(a.row, a.col) < std::make_tuple(b.row, b.col);
+        });
+    }
+
+    // 输出为单行 JSON
+    std::string jsonify() const {
+        std::stringstream ss;
+        ss << "{\"rows\": " << rcnt << ", \"cols\": " << ccnt << ", \"crossings\": [";
+        for(size_t i = 0; i < crossings.size(); i += 1) {
+            const auto& info = crossings[i];
+            if(i != 0) ss << ", ";
+            ss << "{\"row\": " << info.row
+               << ", \"col\": " << info.col
+               << ", \"value\": " << info.value
+               << ", \"base_direction\": " << info.base_direction
+               << ", \"sockets\": [";
+            for(int k = 0; k < 4; k += 1) {
+                if(k != 0) ss << ", ";
+                ss << info.sockets[k];
+            }
+            ss << "]}";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+};
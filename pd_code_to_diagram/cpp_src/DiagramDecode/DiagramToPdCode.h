@@ -0,0 +1,407 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "../BorderDetect/IntMatrix2/AbstractIntMatrix2.h"
+#include "../Utils/Exceptions.h"
+#include "../Utils/MyAssert.h"
+
+// 从二维布局矩阵还原 pd_code
+// 算法与 Python 端的 from_diagram.diagram_to_pd_code 一致：
+//   1. 根据每个交叉点两侧的编号确定编号之间的前驱后继关系
+//   2. 单独处理长度为 2 的连通分支
+//   3. 给交叉点周围的格子标上行进方向
+//   4. 逐个解析交叉点，无法推出方向的格子由对侧格子推测
+// 任何不合法或者有歧义的矩阵都会抛出 BadDiagramException
+class DiagramToPdCode {
+private:
+    // 东、北、西、南，与 from_diagram.py 中的 DX, DY 相同
+    static constexpr int DX[4] = { 0, -1,  0, 1};
+    static constexpr int DY[4] = { 1,  0, -1, 0};
+
+    // 方向矩阵中的特殊取值，0 ~ 3 表示格子上的行进方向
+    static constexpr int DIR_NONE  = -10; // 不需要定向或者还没有确定定向
+    static constexpr int DIR_IN    = -11; // 进入相邻的交叉点
+    static constexpr int DIR_OUT   = -12; // 离开相邻的交叉点
+    static constexpr int DIR_GUESS = -1;  // 需要由交叉点另一侧推测
+
+    int rcnt, ccnt;
+    std::vector<int> cells;     // 按行存储的矩阵
+    std::vector<int> direction; // 方向矩阵
+    std::vector<std::tuple<int, int>> crossings; // 按行优先顺序排列的所有交叉点
+
+    std::unordered_map<int, int> pre, nxt;
+
+    int at(int i, int j) const {return cells[(size_t)i * ccnt + j];}
+    int& dirAt(int i, int j) {return direction[(size_t)i * ccnt + j];}
+
+    static std::string posText(int i, int j) {
+        return "(" + std::to_string(i) + "," + std::to_string(j) + ")";
+    }
+
+    void addEdge(int val1, int val2) {
+        if(val1 <= 0 || val2 <= 0) {
+            THROW_EXCEPTION(BadDiagramException, "crossing strand without an arc label");
+        }
+        if(val1 > val2) std::swap(val1, val2);
+
+        auto link = [&](int frm, int eto) {
+            auto it_pre = pre.find(eto);
+            auto it_nxt = nxt.find(frm);
+            if((it_pre != pre.end() && it_pre -> second != frm) || (it_nxt != nxt.end() && it_nxt -> second != eto)) {
+                THROW_EXCEPTION(BadDiagramException, "conflicting arc order between "
+                    + std::to_string(frm) + " and " + std::to_string(eto));
+            }
+            pre[eto] = frm;
+            nxt[frm] = eto;
+        };
+        if(val2 - val1 == 1) {
+            link(val1, val2);
+        }else {
+            link(val2, val1); // 编号回绕到连通分支的最小值
+        }
+    }
+
+    // 确定前驱后继关系
+    void buildPreNxt() {
+        for(auto [i, j]: crossings) {
+            for(int d = 0; d < 2; d += 1) {
+                addEdge(at(i + DX[d], j + DY[d]), at(i + DX[d + 2], j + DY[d + 2]));
+            }
+        }
+
+        // 特殊处理长度为 2 的连通分支
+        for(auto [item, val]: pre) {
+            if(!nxt.count(item)) nxt[item] = val;
+        }
+        for(auto [item, val]: nxt) {
+            if(!pre.count(item)) pre[item] = val;
+        }
+        if(pre.size() != nxt.size()) {
+            THROW_EXCEPTION(BadDiagramException, "inconsistent arc order");
+        }
+    }
+
+    // 从旁边的点 (fi, fj) 前进到交叉点 (xi, xj) 的方向，out 时取反
+    static int getDir(int xi, int xj, int fi, int fj, int in_out) {
+        int dir_now = -1;
+        for(int d = 0; d < 4; d += 1) {
+            if(xi - fi == DX[d] && xj - fj == DY[d]) {
+                dir_now = d;
+            }
+        }
+        ASSERT(dir_now != -1);
+        return in_out == DIR_OUT ? (dir_now + 2) % 4 : dir_now;
+    }
+
+    // 把交叉点周围格子上的 in, out 改写为具体方向
+    void commitInOut(int xi, int xj) {
+        for(int d = 0; d < 4; d += 1) {
+            int& dn = dirAt(xi + DX[d], xj + DY[d]);
+            if(dn == DIR_IN || dn == DIR_OUT) {
+                dn = getDir(xi, xj, xi + DX[d], xj + DY[d], dn);
+            }
+        }
+    }
+
+    bool aroundContains(int xi, int xj, const std::set<int>& component_set) const {
+        for(int val: component_set) {
+            bool found = false;
+            for(int d = 0; d < 4; d += 1) {
+                if(at(xi + DX[d], xj + DY[d]) == val) found = true;
+            }
+            if(!found) return false;
+        }
+        return true;
+    }
+
+    // 长度为 2 的连通分支的两种定向在矩阵中无法区分，约定与 from_diagram.len_2_crossing_key 相同：
+    // 分支从下方穿过的交叉点排在前面，相同时按另一条线的两个编号（从小到大）排序，排在最前面的交叉点上较小的编号对应 in
+    std::tuple<int, int, int> len2CrossingKey(int xi, int xj, const std::set<int>& component_set) const {
+        std::set<int> vertical = {at(xi + DX[1], xj + DY[1]), at(xi + DX[3], xj + DY[3])};
+        bool is_vertical = (vertical == component_set);
+        int d = is_vertical ? 0 : 1; // 另一条线所在的方向
+        int other1 = at(xi + DX[d], xj + DY[d]), other2 = at(xi + DX[d + 2], xj + DY[d + 2]);
+
+        // -1 表示竖直方向的线从下方穿过，-2 表示水平方向的线从下方穿过
+        bool under = (at(xi, xj) == (is_vertical ? -1 : -2));
+        return std::make_tuple(under ? 0 : 1, std::min(other1, other2), std::max(other1, other2));
+    }
+
+    void processLen2Components(const std::vector<std::set<int>>& len_2_components) {
+        for(const auto& component_set: len_2_components) {
+            std::vector<std::tuple<int, int>> related;
+            for(auto [i, j]: crossings) {
+                if(aroundContains(i, j, component_set)) {
+                    related.push_back(std::make_tuple(i, j));
+                }
+            }
+            if(related.empty() || related.size() > 2) {
+                THROW_EXCEPTION(BadDiagramException, "a two-arc component touches "
+                    + std::to_string(related.size()) + " crossings");
+            }
+
+            if(related.size() == 1) {
+                // 只有一个 crossing 只能是一个 [a, b, b, a] 或者 [a, a, b, b]
+                auto [xi, xj] = related[0];
+                std::set<int> around;
+                for(int d = 0; d < 4; d += 1) around.insert(at(xi + DX[d], xj + DY[d]));
+                if(around != component_set) {
+                    THROW_EXCEPTION(BadDiagramException, "unexpected labels around " + posText(xi, xj));
+                }
+                dirAt(xi, xj + 1) = DIR_IN;
+                dirAt(xi, xj - 1) = DIR_OUT;
+
+                // 每个值都是进一次，出一次，所以只需要看另外两个元素的值
+                int val1 = at(xi, xj + 1);
+                int val2 = at(xi, xj - 1);
+                for(int d = 0; d < 4; d += 1) {
+                    int& dn = dirAt(xi + DX[d], xj + DY[d]);
+                    if(dn != DIR_NONE) continue;
+                    int val = at(xi + DX[d], xj + DY[d]);
+                    if(val == val1) {
+                        dn = DIR_OUT;
+                    }else {
+                        if(val != val2) {
+                            THROW_EXCEPTION(BadDiagramException, "unexpected labels around " + posText(xi, xj));
+                        }
+                        dn = DIR_IN;
+                    }
+                }
+                commitInOut(xi, xj);
+
+            }else {
+                std::stable_sort(related.begin(), related.end(), [&](const auto& lhs, const auto& rhs) {
+                    return len2CrossingKey(std::get<0>(lhs), std::get<1>(lhs), component_set)
+                         < len2CrossingKey(std::get<0>(rhs), std::get<1>(rhs), component_set);
+                });
+                int val1 = *component_set.begin();  // val1 对应 in
+                int val2 = *component_set.rbegin(); // val2 对应 out
+                for(auto [xi, xj]: related) {
+                    for(int d = 0; d < 4; d += 1) {
+                        int val = at(xi + DX[d], xj + DY[d]);
+                        if(val == val1) {
+                            dirAt(xi + DX[d], xj + DY[d]) = DIR_IN;
+                        }else if(val == val2) {
+                            dirAt(xi + DX[d], xj + DY[d]) = DIR_OUT;
+                        }
+                    }
+                    // 交换之后，下一个交叉点就能恰好实现相反方向
+                    std::swap(val1, val2);
+                }
+                for(auto [xi, xj]: related) {
+                    commitInOut(xi, xj);
+                }
+            }
+        }
+
+        // 仅仅出现了一次的数字，其方向需要额外推测
+        std::unordered_map<int, int> number_cnt;
+        for(int val: cells) {
+            if(val > 0) number_cnt[val] += 1;
+        }
+        for(size_t k = 0; k < cells.size(); k += 1) {
+            if(cells[k] > 0 && number_cnt[cells[k]] == 1) {
+                direction[k] = DIR_GUESS;
+            }
+        }
+    }
+
+    // 根据前驱后继关系确定交叉点周围的方向
+    void orientCrossings() {
+        for(auto [xi, xj]: crossings) {
+            for(int d = 0; d < 4; d += 1) {
+                int& dn = dirAt(xi + DX[d], xj + DY[d]);
+                if(dn != DIR_NONE) continue;
+                int hr_val = at(xi + DX[d], xj + DY[d]);
+                int op_val = at(xi + DX[(d + 2) % 4], xj + DY[(d + 2) % 4]);
+                auto it = nxt.find(hr_val);
+                if(it == nxt.end()) {
+                    THROW_EXCEPTION(BadDiagramException, "arc " + std::to_string(hr_val) + " has no successor");
+                }
+                dn = (op_val == it -> second) ? DIR_IN : DIR_OUT;
+            }
+            commitInOut(xi, xj);
+        }
+    }
+
+    // 解析一个交叉点，如果还无法确定方向则返回 false
+    // filled 中记录本次推测出方向的格子对应的方向编号
+    bool getPdCodeCrossing(int xi, int xj, std::vector<int>& record, std::vector<int>& filled) {
+        int dir[4]; // DIR_NONE, DIR_IN 或 DIR_OUT
+        for(int d = 0; d < 4; d += 1) {
+            dir[d] = DIR_NONE;
+            int dn = dirAt(xi + DX[d], xj + DY[d]);
+            if(dn == DIR_GUESS) continue;
+            if(dn != d && dn != (d + 2) % 4) {
+                THROW_EXCEPTION(BadDiagramException, "strand direction does not pass straight through " + posText(xi, xj));
+            }
+            dir[d] = (dn == d) ? DIR_OUT : DIR_IN;
+        }
+
+        for(int i = 0; i < 4; i += 1) {
+            if(dir[i] != DIR_NONE) continue;
+            if(dir[(i + 2) % 4] == DIR_IN) {
+                dir[i] = DIR_OUT;
+                dirAt(xi + DX[i], xj + DY[i]) = i;
+                filled.push_back(i);
+            }else if(dir[(i + 2) % 4] == DIR_OUT) {
+                dir[i] = DIR_IN;
+                dirAt(xi + DX[i], xj + DY[i]) = (i + 2) % 4;
+                filled.push_back(i);
+            }else {
+                return false; // 两头都需要推测，暂时无法确定方向
+            }
+        }
+
+        int val = at(xi, xj);
+        int dir_set[2];
+        if(val == -1) {
+            dir_set[0] = 1; dir_set[1] = 3;
+        }else if(val == -2) {
+            dir_set[0] = 0; dir_set[1] = 2;
+        }else {
+            THROW_EXCEPTION(BadDiagramException, "unsupported crossing value " + std::to_string(val) + " at " + posText(xi, xj));
+        }
+
+        // 找到下方进入的那一个方向
+        int down_dir = -1;
+        for(int d: dir_set) {
+            if(dir[d] == DIR_IN) down_dir = d;
+        }
+        if(down_dir == -1) {
+            THROW_EXCEPTION(BadDiagramException, "no under strand enters " + posText(xi, xj));
+        }
+
+        record.clear();
+        for(int i = 0; i < 4; i += 1) {
+            int d = (down_dir + i) % 4;
+            record.push_back(at(xi + DX[d], xj + DY[d]));
+        }
+        return true;
+    }
+
+    // 每个交叉点恰好解析一次
+    // 推测出一个格子的方向后，只需要重新检查这个格子另一侧的交叉点
+    std::vector<std::vector<int>> resolveCrossings() {
+        std::unordered_map<long long, int> crossing_index;
+        for(int k = 0; k < (int)crossings.size(); k += 1) {
+            auto [i, j] = crossings[k];
+            crossing_index[(long long)i * ccnt + j] = k;
+        }
+
+        std::vector<bool> resolved(crossings.size(), false);
+        std::vector<bool> queued(crossings.size(), true);
+        std::deque<int> work;
+        for(int k = 0; k < (int)crossings.size(); k += 1) work.push_back(k);
+
+        std::vector<std::vector<int>> ans;
+        std::vector<int> record, filled;
+        while(!work.empty()) {
+            int k = work.front();
+            work.pop_front();
+            queued[k] = false;
+            if(resolved[k]) continue;
+
+            auto [xi, xj] = crossings[k];
+            filled.clear();
+            if(getPdCodeCrossing(xi, xj, record, filled)) {
+                resolved[k] = true;
+                ans.push_back(record);
+            }
+            for(int d: filled) {
+                int oi = xi + 2 * DX[d], oj = xj + 2 * DY[d];
+                if(oi < 0 || oi >= rcnt || oj < 0 || oj >= ccnt) continue;
+                auto it = crossing_index.find((long long)oi * ccnt + oj);
+                if(it != crossing_index.end() && !resolved[it -> second] && !queued[it -> second]) {
+                    queued[it -> second] = true;
+                    work.push_back(it -> second);
+                }
+            }
+        }
+
+        std::string positions;
+        for(int k = 0; k < (int)crossings.size(); k += 1) {
+            if(resolved[k]) continue;
+            auto [i, j] = crossings[k];
+            positions += (positions.empty() ? "" : ", ") + posText(i, j);
+        }
+        if(!positions.empty()) {
+            THROW_EXCEPTION(BadDiagramException, "could not infer orientations at crossings: " + positions);
+        }
+        return ans;
+    }
+
+public:
+    // 结果按照字典序排序
+    std::vector<std::vector<int>> convert(const AbstractIntMatrix2& aim) {
+        rcnt = aim.getRcnt();
+        ccnt = aim.getCcnt();
+        if(rcnt <= 0 || ccnt <= 0) {
+            THROW_EXCEPTION(BadDiagramException, "empty diagram");
+        }
+        cells.assign((size_t)rcnt * ccnt, 0);
+        direction.assign((size_t)rcnt * ccnt, DIR_NONE);
+        crossings.clear();
+        pre.clear();
+        nxt.clear();
+
+        for(int i = 0; i < rcnt; i += 1) {
+            for(int j = 0; j < ccnt; j += 1) {
+                int val = aim.getPos(i, j);
+                cells[(size_t)i * ccnt + j] = val;
+                if(val < 0) {
+                    // -1, -2 不可以出现在矩阵边界
+                    if(!(1 <= i && i <= rcnt - 2) || !(1 <= j && j <= ccnt - 2)) {
+                        THROW_EXCEPTION(BadDiagramException, "crossing on the matrix border at " + posText(i, j));
+                    }
+                    crossings.push_back(std::make_tuple(i, j));
+                }
+            }
+        }
+
+        buildPreNxt();
+
+        std::vector<std::set<int>> len_2_components;
+        for(auto [item, val]: pre) {
+            if(nxt[item] != val) continue;
+            std::set<int> component_set = {item, val};
+            if(std::find(len_2_components.begin(), len_2_components.end(), component_set) == len_2_components.end()) {
+                len_2_components.push_back(component_set);
+            }
+        }
+        std::sort(len_2_components.begin(), len_2_components.end());
+        if(!len_2_components.empty()) {
+            processLen2Components(len_2_components);
+        }
+
+        orientCrossings();
+        auto ans = resolveCrossings();
+        std::sort(ans.begin(), ans.end());
+        return ans;
+    }
+
+    // 输出为 JSON 格式的 pd_code
+    static std::string jsonify(const std::vector<std::vector<int>>& pd_code) {
+        std::stringstream ss;
+        ss << "[";
+        for(size_t i = 0; i < pd_code.size(); i += 1) {
+            if(i != 0) ss << ", ";
+            ss << "[";
+            for(size_t j = 0; j < pd_code[i].size(); j += 1) {
+                if(j != 0) ss << ", ";
+                ss << pd_code[i][j];
+            }
+            ss << "]";
+        }
+        ss << "]";
+        return ss.str();
+    }
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../PathEngine/GraphEngine/AbstractGraphEngine.h"
+#include "../PDTreeAlgo/PDCode.h"
+#include "../Utils/Coord2dPosition.h"
+#include "../Utils/Direction.h"
+
+// 在引擎内部检查布线结果是否与输入的 pd_code 一致
+// 只使用最终地图（交叉点为负数，弧为正数），不依赖布线过程中的中间信息：
+//   1. 从每个交叉点的每个 socket 出发沿着同一编号的格子行走，必须到达另一个交叉点
+//   2. 按照 E, N, W, S（逆时针）的顺序读出交叉点四周的编号，重建交叉点记录
+//   3. 与输入的交叉点记录作为多重集比较
+// 布局图中没有弧的方向信息，因此一个交叉点记录可以从下方线的任意一端开始读
+// 比较时把 [a, b, c, d] 与 [c, d, a, b] 视为相同
+class LayoutVerifier {
+private:
+    typedef std::tuple<int, int> Point;
+
+    static Point step(const Point& pos, int dir) {
+        auto delta = Coord2dPosition::getDeltaPositionByDirection((Direction)dir);
+        return Point(
+            std::get<0>(pos) + (int)round(delta.getX()),
+            std::get<1>(pos) + (int)round(delta.getY()));
+    }
+
+    static std::vector<int> canonical(const std::vector<int>& record) {
+        std::vector<int> rotated = {record[2], record[3], record[0], record[1]};
+        return std::min(record, rotated);
+    }
+
+    static std::string posText(const Point& pos) {
+        return "(" + std::to_string(std::get<0>(pos)) + "," + std::to_string(std::get<1>(pos)) + ")";
+    }
+
+    static std::string recordText(const std::vector<int>& record) {
+        std::string ans = "[";
+        for(int i = 0; i < (int)record.size(); i += 1) {
+            ans += (i ? "," : "") + std::to_string(record[i]);
+        }
+        return ans + "]";
+    }
+
+    // 从交叉点 start 的 dir 方向出发沿编号为 label 的格子行走
+    // 成功时返回到达的交叉点，失败时在 reason 中写明原因
+    static bool traceArc(const AbstractGraphEngine& graph, const Point& start, int dir, int label,
+        long long max_steps, std::string& reason) {
+
+        Point prev = start;
+        Point cur  = step(start, dir);
+        for(long long steps = 0; steps <= max_steps; steps += 1) {
+            std::vector<Point> candidates;
+            bool reach_crossing = false;
+            for(int d = 0; d < 4; d += 1) {
+                Point nxt = step(cur, d);
+                if(nxt == prev) continue;
+                int val = graph.getPos(std::get<0>(nxt), std::get<1>(nxt));
+                if(val == label || val < 0) {
+                    candidates.push_back(nxt);
+                    reach_crossing = (val < 0);
+                }
+            }
+            if(candidates.size() != 1) {
+                reason = "arc " + std::to_string(label) + " "
+                    + (candidates.empty() ? "stops" : "branches") + " at " + posText(cur);
+                return false;
+            }
+            if(reach_crossing) {
+                return true;
+            }
+            prev = cur;
+            cur = candidates[0];
+        }
+        reason = "arc " + std::to_string(label) + " does not end at a crossing";
+        return false;
+    }
+
+public:
+    // 检查通过时返回 true，否则返回 false 并在 reason 中给出第一个发现的问题
+    static bool verify(const AbstractGraphEngine& graph, const PDCode& pd_code, std::string& reason) {
+        reason = "";
+        const int n = pd_code.getCrossingNumber();
+
+        auto crossing_pos = graph.getAllNegPos();
+        if((int)crossing_pos.size() != n) {
+            reason = "expected " + std::to_string(n) + " crossings, found " + std::to_string(crossing_pos.size());
+            return false;
+        }
+
+        int xmin, xmax, ymin, ymax;
+        std::tie(xmin, xmax, ymin, ymax) = graph.getBorderCoord();
+        long long max_steps = (long long)(xmax - xmin + 3) * (ymax - ymin + 3);
+
+        std::map<int, int> socket_cnt; // 每个编号作为 socket 出现的次数
+        std::vector<std::vector<int>> rebuilt;
+        for(const auto& pos: crossing_pos) {
+            int val = graph.getPos(std::get<0>(pos), std::get<1>(pos));
+
+            // -1: 下方线沿 E/W 方向，-2: 下方线沿 N/S 方向
+            int base_dir;
+            if(val == -1) {
+                base_dir = (int)Direction::EAST;
+            }else if(val == -2) {
+                base_dir = (int)Direction::NORTH;
+            }else {
+                reason = "unsupported crossing value " + std::to_string(val) + " at " + posText(pos);
+                return false;
+            }
+
+            std::vector<int> record;
+            for(int i = 0; i < 4; i += 1) {
+                int dir = (base_dir + i) % 4;
+                Point socket = step(pos, dir);
+                int label = graph.getPos(std::get<0>(socket), std::get<1>(socket));
+                if(label <= 0) {
+                    reason = "crossing " + posText(pos) + " has no arc on one side";
+                    return false;
+                }
+                if(!traceArc(graph, pos, dir, label, max_steps, reason)) {
+                    return false;
+                }
+                socket_cnt[label] += 1;
+                record.push_back(label);
+            }
+            rebuilt.push_back(canonical(record));
+        }
+
+        for(const auto& [label, cnt]: socket_cnt) {
+            if(cnt != 2) {
+                reason = "arc " + std::to_string(label) + " touches " + std::to_string(cnt) + " sockets";
+                return false;
+            }
+        }
+
+        std::vector<std::vector<int>> expected;
+        for(int i = 0; i < n; i += 1) {
+            expected.push_back(canonical(pd_code.getCrossing(i).getRaw()));
+        }
+        std::sort(rebuilt.begin(), rebuilt.end());
+        std::sort(expected.begin(), expected.end());
+        for(int i = 0; i < n; i += 1) {
+            if(rebuilt[i] != expected[i]) {
+                reason = "crossing record " + recordText(rebuilt[i])
+                    + " does not match " + recordText(expected[i]);
+                return false;
+            }
+        }
+        return true;
+    }
+};
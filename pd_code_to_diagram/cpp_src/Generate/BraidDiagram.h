@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../Utils/MyAssert.h"
+
+// 由辫子（或者带帽子的 plat 形式）生成 PD code
+// 位置 0 到 strands - 1 从左到右排列，交叉点从上到下依次放置
+// 每个交叉点都位于相邻的位置 j 与 j + 1 之间，sign > 0 时左上到右下的线在上方
+class BraidDiagram {
+public:
+    struct Generator {
+        int pos;  // 交叉点左侧的位置
+        int sign; // +1 或者 -1
+    };
+
+private:
+    // 交叉点的四个端口：左上、右上、左下、右下
+    static constexpr int TL = 0;
+    static constexpr int TR = 1;
+    static constexpr int BL = 2;
+    static constexpr int BR = 3;
+
+    int strands;
+    std::vector<Generator> gens;
+    std::vector<std::pair<int, int>> top_caps;    // 为空表示辫子闭包
+    std::vector<std::pair<int, int>> bottom_caps;
+
+    int crossingCnt() const {return (int)gens.size();}
+    int topNode(int p) const {return 4 * crossingCnt() + p;}
+    int bottomNode(int p) const {return 4 * crossingCnt() + strands + p;}
+    bool isPort(int node) const {return node < 4 * crossingCnt();}
+
+    // 同一条线穿过交叉点时从哪个端口出去
+    static int partner(int port) {
+        return (port & ~3) | (3 - (port & 3));
+    }
+
+public:
+    BraidDiagram(int _strands, std::vector<Generator> _gens):
+        strands(_strands), gens(std::move(_gens)) {}
+
+    // plat 形式：上下两端用不相交的帽子两两连接位置
+    BraidDiagram(int _strands, std::vector<Generator> _gens,
+        std::vector<std::pair<int, int>> _top_caps, std::vector<std::pair<int, int>> _bottom_caps):
+        strands(_strands), gens(std::move(_gens)), top_caps(std::move(_top_caps)), bottom_caps(std::move(_bottom_caps)) {
+        ASSERT((int)top_caps.size() * 2 == strands && (int)bottom_caps.size() * 2 == strands);
+    }
+
+    // 只由辫子的置换与帽子计算连通分支个数，不需要构造 PD code
+    int componentCnt() const {
+        std::vector<int> perm(strands); // 从顶端位置 p 出发的线到达底端的位置
+        for(int p = 0; p < strands; p += 1) perm[p] = p;
+        std::vector<int> at(strands);   // 当前位于位置 q 上的线
+        for(int p = 0; p < strands; p += 1) at[p] = p;
+        for(const auto& gen: gens) {
+            std::swap(at[gen.pos], at[gen.pos + 1]);
+        }
+        for(int q = 0; q < strands; q += 1) perm[at[q]] = q;
+
+        // 顶端节点 p 与底端节点 strands + p，每个节点恰好连接两条线，连通块的个数就是分支个数
+        std::vector<int> parent(2 * strands);
+        for(int u = 0; u < 2 * strands; u += 1) parent[u] = u;
+        auto find = [&](int u) {
+            while(parent[u] != u) u = parent[u] = parent[parent[u]];
+            return u;
+        };
+        int component_cnt = 2 * strands;
+        auto unite = [&](int u, int v) {
+            u = find(u), v = find(v);
+            if(u != v) {
+                parent[u] = v;
+                component_cnt -= 1;
+            }
+        };
+        for(int p = 0; p < strands; p += 1) unite(p, strands + perm[p]);
+        if(top_caps.empty()) {
+            for(int p = 0; p < strands; p += 1) unite(p, strands + p);
+        }else {
+            for(auto [p, q]: top_caps) unite(p, q);
+            for(auto [p, q]: bottom_caps) unite(strands + p, strands + q);
+        }
+        return component_cnt;
+    }
+
+    // 计算 PD code，成功时返回 true
+    // 辫子闭包中某个位置上没有交叉点、或者某条弧的两端在同一个交叉点上时返回 false
+    // plat 形式中没有交叉点的分支不会被编号，component_cnt 不包括这些分支
+    bool toPdCode(std::vector<std::vector<int>>& pd_code, int& component_cnt) const {
+        const int n = crossingCnt();
+        const int node_cnt = 4 * n + 2 * strands;
+        std::vector<std::vector<int>> adj(node_cnt);
+        auto link = [&](int u, int v) {
+            adj[u].push_back(v);
+            adj[v].push_back(u);
+        };
+
+        // 沿每个位置从上到下连接经过的端口
+        for(int p = 0; p < strands; p += 1) {
+            int cur = topNode(p);
+            bool touched = false;
+            for(int t = 0; t < n; t += 1) {
+                if(gens[t].pos != p && gens[t].pos + 1 != p) continue;
+                bool left = (gens[t].pos == p);
+                link(cur, 4 * t + (left ? TL : TR));
+                cur = 4 * t + (left ? BL : BR);
+                touched = true;
+            }
+            link(cur, bottomNode(p));
+            if(!touched && top_caps.empty()) return false; // plat 形式中这个位置只是连接上下帽子的一段弧
+        }
+        if(top_caps.empty()) {
+            for(int p = 0; p < strands; p += 1) {
+                link(topNode(p), bottomNode(p));
+            }
+        }else {
+            for(auto [p, q]: top_caps) link(topNode(p), topNode(q));
+            for(auto [p, q]: bottom_caps) link(bottomNode(p), bottomNode(q));
+        }
+
+        // 从端口出发沿外部连线走到下一个端口
+        auto nextPort = [&](int port) {
+            int prev = port;
+            int cur = adj[port][0];
+            while(!isPort(cur)) {
+                int nxt = (adj[cur][0] == prev) ? adj[cur][1] : adj[cur][0];
+                prev = cur;
+                cur = nxt;
+            }
+            return cur;
+        };
+
+        // 沿着每个连通分支依次给弧编号，incoming 记录端口是否是进入交叉点的一端
+        std::vector<int> label(4 * n, 0);
+        std::vector<char> incoming(4 * n, 0);
+        int next_label = 1;
+        component_cnt = 0;
+        for(int start = 0; start < 4 * n; start += 1) {
+            if(label[start] != 0) continue;
+            component_cnt += 1;
+            int port = start;
+            do {
+                int in_port = nextPort(port);
+                label[port] = next_label;
+                label[in_port] = next_label;
+                incoming[in_port] = 1;
+                next_label += 1;
+                port = partner(in_port);
+            }while(port != start);
+        }
+
+        // 逆时针顺序：右下、右上、左上、左下
+        static const int ccw[] = {BR, TR, TL, BL};
+        pd_code.clear();
+        for(int t = 0; t < n; t += 1) {
+            int u1 = (gens[t].sign > 0) ? TR : TL; // 下方的线所在的两个端口
+            int u2 = partner(4 * t + u1) & 3;
+            int a = incoming[4 * t + u1] ? u1 : u2;
+            int k = (int)(std::find(ccw, ccw + 4, a) - ccw);
+            std::vector<int> crossing;
+            for(int d = 0; d < 4; d += 1) {
+                crossing.push_back(label[4 * t + ccw[(k + d) % 4]]);
+            }
+            auto sorted = crossing;
+            std::sort(sorted.begin(), sorted.end());
+            if(std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+                return false;
+            }
+            pd_code.push_back(crossing);
+        }
+        return true;
+    }
+};
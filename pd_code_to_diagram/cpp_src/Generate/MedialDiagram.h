@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+// 随机平面四正则图：先随机生成一个平面图 G，它的中点图（medial graph）就是平面四正则图
+// 每个连通的平面四正则图都是某个平面图的中点图，G 的每条边对应一个交叉点
+//
+// G 用半边结构表示：边 e 的两条半边是 2e 与 2e + 1，nxt[d] 是沿 d 左侧的面走到的下一条半边
+// 从两条平行边构成的二边形出发，每一步在一个面内加一条弦，或者把一条边细分为两条
+// 这两种操作都保持 G 没有自环、没有桥，因此中点图中不会出现可以直接去掉的交叉点
+// 每一步都会改变中点图在新交叉点处的连接方式，可能合并或者拆分连通分支
+// 生成过程中拒绝使连通分支数超过目标的操作，否则交叉点较多时几乎不可能得到扭结
+// 分支数低于目标时也先拒绝使分支数减少的操作，否则分支较多、交叉点接近 2k 时几乎不可能恰好得到 k 个分支
+class MedialDiagram {
+private:
+    std::vector<int> nxt;    // 面上的下一条半边
+    std::vector<int> prv;    // 面上的上一条半边
+    std::vector<int> origin; // 半边的起点
+    int vertex_cnt = 0;
+
+    // 计算连通分支时使用的临时数组，避免每一步重新分配
+    mutable std::vector<int> end0, end1, port_arc, label;
+
+    int edgeCnt() const {return (int)nxt.size() / 2;}
+
+    int newEdge(int u, int v) {
+        int d = (int)nxt.size();
+        nxt.resize(d + 2);
+        prv.resize(d + 2);
+        origin.push_back(u);
+        origin.push_back(v);
+        return d;
+    }
+
+    static int twin(int d) {return d ^ 1;}
+
+    // 在 a 与 b 所在的同一个面中，从 origin(a) 到 origin(b) 加一条弦
+    void addChord(int a, int b) {
+        int c = newEdge(origin[a], origin[b]);
+        int pa = prv[a], pb = prv[b];
+        nxt[pa] = c;         prv[c] = pa;
+        nxt[c] = b;          prv[b] = c;
+        nxt[pb] = twin(c);   prv[twin(c)] = pb;
+        nxt[twin(c)] = a;    prv[a] = twin(c);
+    }
+
+    // 把半边 d 所在的边从中间细分，新顶点之后的一段成为新边
+    void subdivide(int d) {
+        int t = twin(d);
+        int w = vertex_cnt++;
+        int v = origin[t];
+        int e = newEdge(w, v); // e: w -> v, twin(e): v -> w
+        int nd = nxt[d], pt = prv[t];
+
+        // d 所在的面：... d, e, nd ...
+        nxt[d] = e;          prv[e] = d;
+        nxt[e] = nd;         prv[nd] = e;
+
+        // t 所在的面：... pt, twin(e), t ...
+        nxt[pt] = twin(e);   prv[twin(e)] = pt;
+        nxt[twin(e)] = t;    prv[t] = twin(e);
+        origin[t] = w;
+    }
+
+    // 随机选择一个操作：在 d 左侧的面中加一条弦，或者细分 d 所在的边
+    void randomStep(std::mt19937& rng, std::vector<int>& candidates) {
+        int d = (int)(rng() % (unsigned)nxt.size());
+        if(rng() % 3 == 0) {
+            subdivide(d);
+            return;
+        }
+
+        // 在 d 左侧的面中随机选择另一条起点不同的半边
+        candidates.clear();
+        for(int f = nxt[d]; f != d; f = nxt[f]) {
+            if(origin[f] != origin[d]) candidates.push_back(f);
+        }
+        if(candidates.empty()) {
+            subdivide(d);
+        }else {
+            addChord(d, candidates[rng() % (unsigned)candidates.size()]);
+        }
+    }
+
+    // 计算每条弧（G 的角）两端所在的端口，返回 false 表示有弧的两端在同一个交叉点上
+    // 弧对应 G 的角：半边 c 的角从边 c / 2 的中点走到边 nxt[c] / 2 的中点
+    // 交叉点 e 的四个端口逆时针依次为角 2e, prv[2e], 2e + 1, prv[2e + 1]，相对的端口属于同一条线
+    bool buildPorts() const {
+        const int arc_cnt = (int)nxt.size();
+        end0.resize(arc_cnt);
+        end1.resize(arc_cnt);
+        port_arc.resize(2 * arc_cnt);
+        for(int c = 0; c < arc_cnt; c += 1) {
+            int e0 = c / 2, e1 = nxt[c] / 2;
+            if(e0 == e1) return false;
+            end0[c] = 4 * e0 + ((c & 1) ? 2 : 0);
+            end1[c] = 4 * e1 + ((nxt[c] & 1) ? 3 : 1);
+            port_arc[end0[c]] = c;
+            port_arc[end1[c]] = c;
+        }
+        return true;
+    }
+
+    // 沿每个连通分支依次给弧编号（从 1 开始），返回连通分支个数
+    // incoming 不为空时记录端口是否是进入交叉点的一端
+    int labelArcs(std::vector<char>* incoming) const {
+        const int arc_cnt = (int)nxt.size();
+        label.assign(arc_cnt, 0);
+        int next_label = 1;
+        int component_cnt = 0;
+        for(int start = 0; start < arc_cnt; start += 1) {
+            if(label[start] != 0) continue;
+            component_cnt += 1;
+            int arc = start;
+            int in_end = end1[start];
+            do {
+                label[arc] = next_label++;
+                if(incoming != nullptr) (*incoming)[in_end] = 1;
+                int out_end = (in_end & ~3) | ((in_end + 2) & 3); // 相对的端口
+                arc = port_arc[out_end];
+                in_end = (end0[arc] == out_end) ? end1[arc] : end0[arc];
+            }while(arc != start);
+        }
+        return component_cnt;
+    }
+
+    // 出现两端在同一个交叉点上的弧时返回一个很大的数，使这一步被拒绝
+    int componentCnt() const {
+        if(!buildPorts()) return std::numeric_limits<int>::max();
+        return labelArcs(nullptr);
+    }
+
+public:
+    // 生成一个有 edge_cnt 条边的随机平面图，edge_cnt 至少为 2
+    // 中点图的连通分支数不会在超过 want_components 之后继续增加，但不保证最终恰好等于 want_components
+    MedialDiagram(int edge_cnt, int want_components, std::mt19937& rng) {
+        nxt.reserve(2 * edge_cnt);
+        prv.reserve(2 * edge_cnt);
+        origin.reserve(2 * edge_cnt);
+
+        // 两个顶点之间的两条平行边，围出内外两个面
+        vertex_cnt = 2;
+        int a = newEdge(0, 1);
+        int b = newEdge(1, 0);
+        nxt[a] = b; prv[b] = a; nxt[b] = a; prv[a] = b;                         // 内侧的面
+        nxt[twin(a)] = twin(b); prv[twin(b)] = twin(a);
+        nxt[twin(b)] = twin(a); prv[twin(a)] = twin(b);                         // 外侧的面
+
+        // 最后一步会多尝试几次，尽量恰好得到 want_components 个连通分支
+        static constexpr int LAST_STEP_TRY = 16;
+        // 其他步骤中前几次尝试不接受使分支数远离目标的操作，之后只要求不超过目标
+        static constexpr int KEEP_TRY = 16;
+        std::vector<int> candidates;
+        std::vector<int> old_nxt, old_prv, old_origin;
+        int components = 2;
+        while(edgeCnt() < edge_cnt) {
+            bool last = (edgeCnt() + 1 == edge_cnt);
+            for(int attempt = 0; ; attempt += 1) {
+                old_nxt = nxt;
+                old_prv = prv;
+                old_origin = origin;
+                int old_vertex_cnt = vertex_cnt;
+
+                randomStep(rng, candidates);
+                int now = componentCnt();
+                bool accept = last ? (now == want_components || attempt + 1 >= LAST_STEP_TRY)
+                                   : (now <= std::max(want_components, components)
+                                      && (now >= std::min(want_components, components) || attempt >= KEEP_TRY));
+                if(accept) {
+                    components = now;
+                    break;
+                }
+                nxt.swap(old_nxt);
+                prv.swap(old_prv);
+                origin.swap(old_origin);
+                vertex_cnt = old_vertex_cnt;
+            }
+        }
+    }
+
+    // 中点图的 PD code，每个交叉点上方的线随机选择
+    // 有弧的两端在同一个交叉点上时返回 false
+    bool toPdCode(std::vector<std::vector<int>>& pd_code, int& component_cnt, std::mt19937& rng) const {
+        const int n = edgeCnt();
+        if(!buildPorts()) return false;
+        std::vector<char> incoming(4 * n, 0);
+        component_cnt = labelArcs(&incoming);
+
+        // 随机选择每个交叉点上方的线，PD code 从下方那条线进入的端口开始逆时针列出
+        pd_code.assign(n, std::vector<int>(4));
+        for(int e = 0; e < n; e += 1) {
+            int s = (int)(rng() & 1);
+            int a = incoming[4 * e + s] ? s : s + 2;
+            for(int k = 0; k < 4; k += 1) {
+                pd_code[e][k] = label[port_arc[4 * e + ((a + k) & 3)]];
+            }
+        }
+        return true;
+    }
+};
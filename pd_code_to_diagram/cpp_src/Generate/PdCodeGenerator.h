@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BraidDiagram.h"
+#include "MedialDiagram.h"
+
+// 生成合法的随机 PD code，用于压力测试与吞吐量测试
+//   braid   随机辫子的闭包，每个生成元随机取正负
+//   plat    随机 tangle 的闭包：随机辫子的上下两端各用一组随机的不相交帽子连接
+//   planar  随机平面四正则图（随机平面图的中点图），每个交叉点随机选择上下
+// 所有方法都保证：编号恰好是 1 到 2n 且各出现两次，没有一条弧的两端在同一个交叉点上，图是连通的
+enum class GenerateMethod {
+    BRAID,
+    PLAT,
+    PLANAR
+};
+
+class PdCodeGenerator {
+public:
+    using PdCodeData = std::vector<std::vector<int>>;
+
+    // 单个 PD code 的最大尝试次数，超过时说明参数几乎无法满足
+    static constexpr int MAX_TRY = 100000;
+
+    // 一次 plat 尝试中替换生成元的最大次数
+    static constexpr int PLAT_CLIMB_STEPS = 1000;
+
+private:
+    GenerateMethod method;
+    int crossings;
+    int components;
+    std::mt19937 rng;
+
+    // 随机的不相交帽子：把 0 到 2k - 1 两两配对，且配对之间互不交叉
+    static std::vector<std::pair<int, int>> randomCaps(int strands, std::mt19937& rng) {
+        std::vector<std::pair<int, int>> caps;
+        std::vector<int> stack;
+        int opened = 0;
+        for(int p = 0; p < strands; p += 1) {
+            bool must_open  = stack.empty();
+            bool must_close = (opened == strands / 2);
+            if(must_open || (!must_close && (rng() & 1))) {
+                stack.push_back(p);
+                opened += 1;
+            }else {
+                caps.push_back({stack.back(), p});
+                stack.pop_back();
+            }
+        }
+        return caps;
+    }
+
+    static BraidDiagram::Generator randomGenerator(int strands, std::mt19937& rng) {
+        int j = (int)(rng() % (unsigned)(strands - 1));
+        return {j, (rng() & 1) ? 1 : -1};
+    }
+
+    // 所有交叉点是否通过弧连成一个整体
+    static bool isConnected(const PdCodeData& pd_code) {
+        const int n = (int)pd_code.size();
+        std::vector<int> parent(n), owner(2 * n + 1, -1);
+        for(int i = 0; i < n; i += 1) parent[i] = i;
+        auto find = [&](int u) {
+            while(parent[u] != u) u = parent[u] = parent[parent[u]];
+            return u;
+        };
+        int group_cnt = n;
+        for(int i = 0; i < n; i += 1) {
+            for(int label: pd_code[i]) {
+                if(owner[label] < 0) {
+                    owner[label] = i;
+                    continue;
+                }
+                int u = find(owner[label]), v = find(i);
+                if(u != v) {
+                    parent[u] = v;
+                    group_cnt -= 1;
+                }
+            }
+        }
+        return group_cnt == 1;
+    }
+
+    // plat 闭包中 toPdCode 会拒绝或者一定不连通的局部结构的个数
+    //   相邻位置 p、p + 1 上的帽子，最先（最后）碰到这两个位置的交叉点恰好在它们之间：出现可以直接去掉的交叉点
+    //   没有任何交叉点的位置：这段弧所在的分支可能没有交叉点
+    //   两个相邻位置之间既没有交叉点也没有帽子跨过：左右两部分不连通
+    static int platDefects(int strands, const std::vector<BraidDiagram::Generator>& gens,
+        const std::vector<std::pair<int, int>>& top, const std::vector<std::pair<int, int>>& bottom) {
+        const int n = (int)gens.size();
+        int defects = 0;
+        auto capKink = [&](int p, int from, int step) {
+            for(int t = from; 0 <= t && t < n; t += step) {
+                if(gens[t].pos == p) return 1;
+                if(gens[t].pos == p - 1 || gens[t].pos == p + 1) return 0;
+            }
+            return 0;
+        };
+        for(auto [p, q]: top) {
+            if(q == p + 1) defects += capKink(p, 0, 1);
+        }
+        for(auto [p, q]: bottom) {
+            if(q == p + 1) defects += capKink(p, n - 1, -1);
+        }
+
+        std::vector<char> touched(strands, 0), joined(strands - 1, 0);
+        for(const auto& gen: gens) {
+            touched[gen.pos] = touched[gen.pos + 1] = 1;
+            joined[gen.pos] = 1;
+        }
+        for(const auto* caps: {&top, &bottom}) {
+            for(auto [p, q]: *caps) {
+                for(int j = p; j < q; j += 1) joined[j] = 1;
+            }
+        }
+        defects += (int)std::count(touched.begin(), touched.end(), 0);
+        defects += (int)std::count(joined.begin(), joined.end(), 0);
+        return defects;
+    }
+
+    // 随机的 plat 闭包，失败时返回 false
+    // 直接拒绝采样时分支数越多越难恰好命中，例如 5 个桥、5 个分支要求每个桥各自成为一个分支
+    // 因此随机替换一个生成元或者重新选择一组帽子，只接受代价（分支数之差加上 platDefects）不增加的替换
+    bool randomPlat(PdCodeData& pd_code) {
+        int strands = 2 * getPlatBridges(crossings, components);
+        std::vector<BraidDiagram::Generator> gens;
+        for(int t = 0; t < crossings; t += 1) {
+            gens.push_back(randomGenerator(strands, rng));
+        }
+        auto top = randomCaps(strands, rng);
+        auto bottom = randomCaps(strands, rng);
+        auto cost = [&]() {
+            int cnt = BraidDiagram(strands, gens, top, bottom).componentCnt();
+            return std::abs(cnt - components) + platDefects(strands, gens, top, bottom);
+        };
+
+        int now = cost();
+        for(int step = 0; now != 0 && step < PLAT_CLIMB_STEPS; step += 1) {
+            int t = (int)(rng() % (unsigned)(crossings + 2));
+            if(t < crossings) {
+                auto old = gens[t];
+                gens[t] = randomGenerator(strands, rng);
+                int next = cost();
+                if(next <= now) now = next; else gens[t] = old;
+            }else {
+                auto& caps = (t == crossings) ? top : bottom;
+                auto old = caps;
+                caps = randomCaps(strands, rng);
+                int next = cost();
+                if(next <= now) now = next; else caps = std::move(old);
+            }
+        }
+        if(now != 0) return false;
+
+        // platDefects 只检查局部结构，仍然需要完整的检查
+        int component_cnt = 0;
+        BraidDiagram diagram(strands, gens, top, bottom);
+        return diagram.toPdCode(pd_code, component_cnt) && component_cnt == components && isConnected(pd_code);
+    }
+
+    // 随机的生成元序列，每个位置至少出现两次，避免出现可以直接去掉的交叉点
+    // alternating 为 true 时偶数位置的生成元为正，奇数位置为负，闭包总是交错图
+    static bool randomWord(int strands, int crossings, bool alternating, std::mt19937& rng,
+        std::vector<BraidDiagram::Generator>& gens) {
+        gens.clear();
+        std::vector<int> used(strands - 1, 0);
+        for(int t = 0; t < crossings; t += 1) {
+            int j = (int)(rng() % (unsigned)(strands - 1));
+            int sign = alternating ? ((j % 2 == 0) ? 1 : -1) : ((rng() & 1) ? 1 : -1);
+            gens.push_back({j, sign});
+            used[j] += 1;
+        }
+        return *std::min_element(used.begin(), used.end()) >= 2;
+    }
+
+    bool tryOnce(PdCodeData& pd_code) {
+        int component_cnt = 0;
+        if(method == GenerateMethod::PLANAR) {
+            MedialDiagram diagram(crossings, components, rng);
+            return diagram.toPdCode(pd_code, component_cnt, rng) && component_cnt == components;
+        }
+        if(method == GenerateMethod::PLAT) {
+            return randomPlat(pd_code);
+        }
+        randomBraid(crossings, components, false, rng, &pd_code);
+        return true;
+    }
+
+public:
+    // 参数无法满足时抛出 std::invalid_argument，说明具体的原因
+    PdCodeGenerator(GenerateMethod _method, int _crossings, int _components, unsigned int seed):
+        method(_method), crossings(_crossings), components(_components), rng(seed) {
+        std::string reason = checkParameters(method, crossings, components);
+        if(!reason.empty()) {
+            throw std::invalid_argument(reason);
+        }
+    }
+
+    // 生成之前检查参数能否满足，能满足时返回空字符串，否则返回原因
+    // 没有可以直接去掉的交叉点（一条弧的两端在同一个交叉点上）并且连通的图满足：
+    //   两个分支之间的交叉点个数总是偶数，所以 k 个分支至少需要 2(k - 1) 个交叉点才能连通
+    //   只有一个自交点的分支被分成两个圈，每个圈与其他分支的交叉点也是偶数个，
+    //   其中一个圈上没有其他交叉点时就出现了可以直接去掉的交叉点
+    // 因此 1 个分支至少需要 3 个交叉点，2 个分支不能恰好有 3 个交叉点
+    static std::string checkParameters(GenerateMethod method, int crossings, int components) {
+        const std::string k = std::to_string(components);
+        const std::string n = std::to_string(crossings);
+        if(crossings < 2) {
+            return "a generated PD code needs at least 2 crossings";
+        }
+        if(components < 1) {
+            return "the number of components must be positive";
+        }
+        if(components == 1 && crossings < 3) {
+            return "a knot diagram needs at least 3 crossings; 2 crossings without a kink always give a 2-component link";
+        }
+        if(components == 2 && crossings == 3) {
+            return "no 2-component diagram has exactly 3 crossings without a kink; "
+                   "two components cross an even number of times and a lone self-crossing leaves a kink";
+        }
+        if(components >= 3 && crossings < 2 * components - 2) {
+            return "a connected diagram with " + k + " components needs at least "
+                + std::to_string(2 * components - 2) + " crossings";
+        }
+        if(method == GenerateMethod::BRAID) {
+            // 辫子闭包的每个生成元至少出现两次
+            int strands = getBraidStrands(crossings, components);
+            if(2 * (strands - 1) > crossings) {
+                return "a braid closure with " + k + " components and " + n + " crossings needs "
+                    + std::to_string(strands) + " strands and so at least " + std::to_string(2 * (strands - 1))
+                    + " crossings";
+            }
+        }
+        if(method == GenerateMethod::PLANAR && components >= 3 && crossings < 2 * components) {
+            // 平面图是 2-连通的，中点图不是连通和，每个分支至少要与其他分支交叉 4 次
+            return "planar diagrams are prime, so " + k + " components need at least "
+                + std::to_string(2 * components) + " crossings";
+        }
+        return "";
+    }
+
+    static bool parseMethod(const std::string& text, GenerateMethod& method) {
+        if(text == "braid")  {method = GenerateMethod::BRAID;  return true;}
+        if(text == "plat")   {method = GenerateMethod::PLAT;   return true;}
+        if(text == "planar") {method = GenerateMethod::PLANAR; return true;}
+        return false;
+    }
+
+    // 辫子闭包的连通分支对应置换的轮换，k 个交叉点的置换奇偶性为 k mod 2
+    // 而 strands 个位置上恰有 c 个轮换的置换奇偶性为 (strands - c) mod 2，两者必须相同
+    static int getBraidStrands(int crossings, int components) {
+        int strands = std::max({2, components, std::min(crossings / 2, 3 + crossings / 20)});
+        if((crossings - (strands - components)) % 2 != 0) {
+            strands += 1;
+        }
+        return strands;
+    }
+
+    // plat 闭包使用 2k 个位置，k 个上方的帽子就是 k 个桥，连通分支数不会超过桥数
+    // 只有一个桥时闭包上只有可以直接去掉的交叉点，因此至少使用两个桥
+    // 3 个及以上的分支多用几个桥：桥数等于分支数时每个桥都要各自成为一个分支，很难随机得到
+    static int getPlatBridges(int crossings, int components) {
+        int bridges = std::max({2, components, std::min(crossings / 4, 2 + crossings / 40)});
+        if(components >= 3) {
+            int spare = std::min(components, crossings - 2 * components + 2);
+            bridges = std::max(bridges, components + 1 + spare / 4);
+        }
+        return bridges;
+    }
+
+    // 随机辫子，闭包恰好有 want_components 个连通分支
+    // pd_code 不为空时同时给出闭包的 PD code
+    static BraidDiagram randomBraid(int crossings, int want_components, bool alternating, std::mt19937& rng,
+        PdCodeData* pd_code = nullptr) {
+        int strands = getBraidStrands(crossings, want_components);
+        ASSERT(2 * (strands - 1) <= crossings);
+
+        PdCodeData local;
+        std::vector<BraidDiagram::Generator> gens;
+        for(int t = 0; t < MAX_TRY; t += 1) {
+            if(!randomWord(strands, crossings, alternating, rng, gens)) continue;
+
+            BraidDiagram diagram(strands, gens);
+            int component_cnt = 0;
+            if(diagram.componentCnt() == want_components
+                && diagram.toPdCode(pd_code != nullptr ? *pd_code : local, component_cnt)) {
+                return diagram;
+            }
+        }
+        throw std::runtime_error("could not generate a braid with the requested number of components");
+    }
+
+    // 生成下一个 PD code
+    PdCodeData next() {
+        PdCodeData pd_code;
+        for(int t = 0; t < MAX_TRY; t += 1) {
+            if(tryOnce(pd_code)) {
+                return pd_code;
+            }
+        }
+        throw std::runtime_error("could not generate a PD code with the requested number of components");
+    }
+
+    // 以引擎标准输入相同的格式追加到 out 末尾：[[1, 5, 2, 4], ...]
+    static void appendJson(std::string& out, const PdCodeData& pd_code) {
+        char buf[16];
+        out.push_back('[');
+        for(size_t i = 0; i < pd_code.size(); i += 1) {
+            if(i != 0) out.append(", ");
+            out.push_back('[');
+            for(int k = 0; k < 4; k += 1) {
+                if(k != 0) out.append(", ");
+                auto res = std::to_chars(buf, buf + sizeof(buf), pd_code[i][k]);
+                out.append(buf, res.ptr);
+            }
+            out.push_back(']');
+        }
+        out.push_back(']');
+    }
+};
@@ -3,15 +3,22 @@
 #include <algorithm>
 #include <tuple>
 
+#include "PathEngine/Common/GraphWorkload.h"
 #include "PathEngine/GraphEngine/VectorGraphEngine.h"
 #include "PathEngine/GraphEngine/PixelGraphEngine.h"
 #include "PathEngine/GraphEngineWrap/ErasePointGraphEngineWrap.h"
 #include "PathEngine/GraphEngineWrap/MergeGraphEngineWrap.h"
+#include "PathEngine/GraphEngineWrap/RecordGraphEngineWrap.h"
 #include "PathEngine/GraphEngineWrap/SpanGraphEngineWrap.h"
+#include "PathEngine/PathAlgorithm/SearchArena.h"
 #include "PathEngine/PathAlgorithm/SpfaPathEngine.h"
 #include "PDTreeAlgo/SocketInfo.h"
+#include "Utils/AllocStats.h"
 #include "Utils/Coord2dPosition.h"
+#include "Utils/Counters.h"
 #include "Utils/MyAssert.h"
+#include "Utils/Profiler.h"
+#include "Utils/TimeBudget.h"
 
 template<typename T>
 void vecPushFront(std::vector<T>& vec, T&& value) {
@@ -28,6 +35,7 @@ private:
 
     void rawParsify(int k) {
         ASSERT(crossing_cnt > 0);
+        COUNTER_ADD(COMMIT_COORD_MAP, 1);
         auto c2ds1 = treeEdgeVGE.getCoord2dSet();
         auto c2ds2 = crossingVGE.getCoord2dSet();
         auto c2dsm = Coord2dSet::merge(c2ds1, c2ds2);
@@ -35,6 +43,9 @@ private:
         socket_info.commitCoordMap(c2dsm, k);
         treeEdgeVGE.commitCoordMap(c2dsm, k);
         crossingVGE.commitCoordMap(c2dsm, k);
+        if(GraphWorkloadRecorder::isEnabled()) {
+            GraphWorkloadRecorder::get().commitCoordMap(k);
+        }
     }
 
     // 保持两个节点之间距离
@@ -43,9 +54,11 @@ private:
         rawParsify(6);
     }
 
-    void saveOne(const std::vector<int>& unused_sokcet_id_list) {
+    // 最短路搜索的临时数据都放在 arena 中
+    void saveOne(const std::vector<int>& unused_sokcet_id_list, SearchArena& arena) {
         ASSERT(crossing_cnt > 0);
         auto socket_id = unused_sokcet_id_list[0];
+        SearchHeatmap::setSocketId(socket_id);
 
         // 构建去掉四个点的图
         SpanGraphEngineWrap sgew(crossingVGE);
@@ -58,6 +71,7 @@ private:
         // 确定起点终点，并将其设置为可行走的
         auto vec = socket_info.getInfo(socket_id);
         ASSERT(vec.size() == 2);
+        std::vector<std::tuple<int, int>> erase_pos; // 只用于记录 GraphWorkload
         for(auto pos: vec) { // 设置 epgew 的四个禁用障碍点 (否则会被 SpanGraphEngineWrap 堵死)
             int xpos, ypos;
             Direction dir;
@@ -67,6 +81,8 @@ private:
             int dy = (int)round(Coord2dPosition::getDeltaPositionByDirection(dir).getY());
             epgew.addEmptyPos(xpos, ypos);           // 交叉点本身是可以行走的
             epgew.addEmptyPos(xpos + dx, ypos + dy); // 交叉点旁边的一个点是可以行走的
+            erase_pos.push_back(std::make_tuple(xpos, ypos));
+            erase_pos.push_back(std::make_tuple(xpos + dx, ypos + dy));
         }
 
         // 获取起点以及终点
@@ -75,16 +91,30 @@ private:
 
         // 获取可以行走的坐标范围（预留外界的合法边界）
         int xmin, xmax, ymin, ymax;
-        std::tie(xmin, xmax, ymin, ymax) = epgew.getBorderCoord(); // 这里曾经遇到过调用纯虚函数的报错
+        auto border = epgew.getBorderCoord();
+        std::tie(xmin, xmax, ymin, ymax) = border; // 这里曾经遇到过调用纯虚函数的报错
         xmin -= 5;
         xmax += 5;
         ymin -= 5;
         ymax += 5;
 
+        // 启用 GraphWorkloadRecorder 时记录这次搜索看到的地图以及所有 getPos 查询
+        auto search = [&](const AbstractGraphEngine& age, bool blocked, int xf, int yf, int xt, int yt) {
+            if(!GraphWorkloadRecorder::isEnabled()) {
+                return SpfaPathEngine(&arena).runAlgo(age, xmin, xmax, ymin, ymax, xf, yf, xt, yt);
+            }
+            auto& workload = GraphWorkloadRecorder::get();
+            workload.beginSearch(erase_pos, border, xmin, xmax, ymin, ymax, xf, yf, xt, yt, blocked, x1, y1);
+            RecordGraphEngineWrap rgew(age, workload);
+            auto pr = SpfaPathEngine(&arena).runAlgo(rgew, xmin, xmax, ymin, ymax, xf, yf, xt, yt);
+            workload.endSearch();
+            return pr;
+        };
+
         // 保存路径结果
         std::vector<LineData> path;
         if(x1 != x2 || y1 != y2) {
-            auto pr = SpfaPathEngine().runAlgo(epgew, xmin, xmax, ymin, ymax, x1, y1, x2, y2);
+            auto pr = search(epgew, false, x1, y1, x2, y2);
             ASSERT(std::get<0>(pr) != -1.0);     // 如果这里条件不成立，说明原来的图不是平面图
             ASSERT(std::get<1>(pr).size() != 0); // 如果这里条件不成立，说明原来的图不是平面图
 
@@ -118,7 +148,7 @@ private:
             new_y2 += dy2;
 
             // 计算最短路
-            auto pr = SpfaPathEngine().runAlgo(nmgew, xmin, xmax, ymin, ymax, new_x1, new_y1, new_x2, new_y2);
+            auto pr = search(nmgew, true, new_x1, new_y1, new_x2, new_y2);
             ASSERT(std::get<0>(pr) != -1.0);     // 如果这里条件不成立，说明原来的图不是平面图
             ASSERT(std::get<1>(pr).size() != 0); // 如果这里条件不成立，说明原来的图不是平面图
 
@@ -135,6 +165,9 @@ private:
         for(const LineData& ld: path) {
             auto line_data_now = ld.setV(socket_id); // 编号必须写成当前 socket_id
             treeEdgeVGE.setLine(line_data_now);
+            if(GraphWorkloadRecorder::isEnabled()) {
+                GraphWorkloadRecorder::get().setLine(WorkloadLayer::TREE, line_data_now);
+            }
         }
         socket_info.setUsed(socket_id, true); // 设为已经使用过了
     }
@@ -146,21 +179,41 @@ private:
     }
 
     // 试图将最近的一组边放置到图上
-    void buildOne() {
+    void buildOne(SearchArena& arena) {
         ASSERT(crossing_cnt > 0);
         auto unused_sokcet_id_list = socket_info.getAllUnusedId(crossing_cnt);
         ASSERT(unused_sokcet_id_list.size() > 0); // 至少有一个没有使用过的编号
+        PROFILE_PHASE_ARG("build_one", "socket_id", unused_sokcet_id_list[0]);
 
-        parseArrange();                  // 先把图像稀疏化，使得一定有边可以相连
-        saveOne(unused_sokcet_id_list);  // 把一组 sokcet_id 连接起来
-        compactArrange();                // 再稠密化
+        {
+            PROFILE_PHASE("parsify");
+            ALLOC_SCOPE(COMPACTION);
+            parseArrange();                  // 先把图像稀疏化，使得一定有边可以相连
+        }
+        {
+            PROFILE_PHASE("route");
+            ALLOC_SCOPE(ROUTING);
+            saveOne(unused_sokcet_id_list, arena); // 把一组 sokcet_id 连接起来
+        }
+        {
+            PROFILE_PHASE("compact");
+            ALLOC_SCOPE(COMPACTION);
+            compactArrange();                // 再稠密化
+        }
     }
 
     // 试图最终把所有边都放到图上
+    // 所有搜索共用一个 SearchArena，布线结束时一起释放
     void buildAll() {
         ASSERT(crossing_cnt > 0);
+        SearchArena arena;
         while(socket_info.getUsedCnt() < 2 * crossing_cnt) {
-            buildOne();
+            TimeBudget::check("link_algo");
+            buildOne(arena);
+        }
+        if(GraphWorkloadRecorder::isEnabled()) { // 与输出阶段对最终地图的查询相同
+            auto final_graph = getFinalGraph();
+            GraphWorkloadRecorder::get().finalGraph(final_graph.getBorderCoord(), final_graph.getAllNegPos());
         }
     }
 
@@ -173,6 +226,12 @@ public:
         socket_info.check(_crossing_cnt, component_cnt); // 保证数据合法
         treeEdgeVGE = socket_info.getTreeEdgeVGE();      // 所有的树边
         crossingVGE = socket_info.getCrossingVGE();      // 所有的交叉点节点
+        if(GraphWorkloadRecorder::isEnabled()) {
+            auto& workload = GraphWorkloadRecorder::get();
+            workload.beginRun();
+            for(const auto& line: treeEdgeVGE.getAllEdges()) workload.setLine(WorkloadLayer::TREE, line);
+            for(const auto& line: crossingVGE.getAllEdges()) workload.setLine(WorkloadLayer::CROSSING, line);
+        }
         buildAll();
     }
 
@@ -197,4 +256,17 @@ public:
         ASSERT(crossing_cnt > 0);
         return treeEdgeVGE.getAllEdges();
     }
+
+    // 获取布线完成后的 socket 信息（坐标与最终地图一致）
+    const SocketInfo& getSocketInfo() const {
+        ASSERT(crossing_cnt > 0);
+        return socket_info;
+    }
+
+    // 拷贝所有交叉点的信息
+    // 每个交叉点是一条零长度线段，值为 -1 或 -2
+    std::vector<LineData> getAllCrossings() const {
+        ASSERT(crossing_cnt > 0);
+        return crossingVGE.getAllEdges();
+    }
 };
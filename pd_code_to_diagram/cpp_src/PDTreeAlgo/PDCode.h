@@ -2,6 +2,7 @@
 
 #include <istream>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
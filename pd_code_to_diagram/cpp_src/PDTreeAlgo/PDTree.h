@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "../Utils/Coord2dPosition.h"
+#include "../Utils/Counters.h"
 #include "../Utils/Direction.h"
 #include "../Utils/MyAssert.h"
 #include "../Utils/Exceptions.h"
@@ -309,6 +310,7 @@ private:
 
                 // 如果以下条件不成立，我们认为已经出现了重合位置
                 if(!(leaf_info.right >= - 0.5 * getPositionPunish())) {
+                    COUNTER_ADD(EXC_CROSSING_MEET, 1);
                     THROW_EXCEPTION(CrossingMeetException, "");
                 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <tuple>
 #include <vector>
 
 #include "../Utils/Debug.h"
@@ -158,6 +159,24 @@ public:
         ASSERT(checked == true);
     }
 
+    // 获取每个交叉点处按 pd_code 顺序排列的四个 socket 编号
+    // 第 k 个 socket 位于 base 方向逆时针旋转 k 次的方向上
+    std::map<std::tuple<int, int>, std::vector<int>> getCrossingRecords() const {
+        std::map<std::tuple<int, int>, std::vector<int>> ans;
+        for(const auto& [pos, base]: crossing_base_direction) {
+            ans[pos] = std::vector<int>(4, 0);
+        }
+        for(const auto& [socket_id, socket_list]: socket_info) {
+            for(const auto& [xpos, ypos, dir]: socket_list) {
+                auto it = ans.find(std::make_tuple(xpos, ypos));
+                ASSERT(it != ans.end());
+                int delta_dir = (4 + (int)dir - (int)getBaseDirection(xpos, ypos)) % 4;
+                it -> second[delta_dir] = socket_id;
+            }
+        }
+        return ans;
+    }
+
     // 获取得到所有树边对应的 VGE
     VectorGraphEngine getTreeEdgeVGE() const {
         ASSERT(checked == true);
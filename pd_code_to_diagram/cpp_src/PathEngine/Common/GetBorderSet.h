@@ -6,7 +6,11 @@
 #include <tuple>
 
 #include "IntMatrix.h"
+#include "LineData.h"
 #include "AbstractIntMatrix.h"
+#include "../GraphEngine/AbstractGraphEngine.h"
+#include "../../BorderDetect/OuterFaceDetect.h"
+#include "../../Utils/BitGrid.h"
 #include "../../Utils/MyAssert.h"
 
 class GetBorderSet {
@@ -26,11 +30,26 @@ public:
     }
 
     GetBorderSet(const AbstractIntMatrix& aim) {
-        IntMatrix vis(aim.getRowCnt(), aim.getColCnt());
+        computeDense(aim);
+    }
+
+    // 优先直接在布线得到的线段上计算外部面，代价只与线段数目有关
+    // graph 是这些线段所在的地图，只有线段图不符合预期时才会导出矩阵
+    GetBorderSet(const std::vector<LineData>& edges, const AbstractGraphEngine& graph) {
+        if(!OuterFaceDetect::getBorderLabels(edges, border_set)) {
+            computeDense(graph.exportToIntMatrix());
+        }
+    }
+
+private:
+    // 在稠密矩阵上从左上角出发 BFS，收集与可达空地相邻的所有非零值
+    void computeDense(const AbstractIntMatrix& aim) {
+        border_set.clear();
+        BitGrid vis(aim.getRowCnt(), aim.getColCnt());
 
         std::queue<std::tuple<int, int> > que; // BFS 算法
 
-        vis.setPos(0, 0, 1); // 记录已经访问过了
+        vis.set(0, 0, true); // 记录已经访问过了
         que.push(std::make_tuple(0, 0));
         ASSERT(aim.getPos(0, 0) == 0); // 左上角的位置必须是零，因为我们要求有一圈零边界
 
@@ -50,10 +69,10 @@ public:
                     if(aim.getPos(newx, newy) != 0) {
                         continue; // 跳过障碍物
                     }
-                    if(vis.getPos(newx, newy) != 0) continue; // 跳过已经访问过的位置
+                    if(vis.get(newx, newy)) continue; // 跳过已经访问过的位置
 
                     // 访问这个位置
-                    vis.setPos(newx, newy, 1);
+                    vis.set(newx, newy, true);
                     que.push(std::make_tuple(newx, newy));
                 }
             }
@@ -68,7 +87,8 @@ public:
                 for(int d = 0; d < 4; d += 1) {
                     int x = i + dx[d];
                     int y = j + dy[d];
-                    if(vis.getPos(x, y) != 0) { // 周围找到了被访问的元素
+                    bool inside = 0 <= x && x < aim.getRowCnt() && 0 <= y && y < aim.getColCnt();
+                    if(inside && vis.get(x, y)) { // 周围找到了被访问的元素
                         vcnt += 1;
                     }
                 }
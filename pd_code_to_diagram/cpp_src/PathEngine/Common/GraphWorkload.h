@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../../Utils/EnableFlag.h"
+#include "LineData.h"
+
+// LinkAlgo 对地图引擎的一串调用，用于在 Bench/engine_bench.cpp 中离线重放
+// 数据是一串 int32（本机字节序），每条记录以 WorkloadOp 开头：
+//   BEGIN_RUN                                  一次 LinkAlgo 开始，两层地图都清空
+//   SET_LINE layer xf xt yf yt v               向 TREE 或 CROSSING 层写入一条线段
+//   COMMIT_COORD_MAP k                         两层共用合并后的坐标集合做一次坐标映射（LinkAlgo::rawParsify）
+//   SEARCH                                     一次最短路搜索看到的地图以及它的所有 getPos 查询
+//     erase_cnt (x y)*erase_cnt                ErasePointGraphEngineWrap 中强制为空的点
+//     bxmin bxmax bymin bymax                  ErasePointGraphEngineWrap::getBorderCoord 的返回值
+//     xmin xmax ymin ymax xf yf xt yt          MarginGraphEngineWrap 的范围与起点终点
+//     blocked px py                            blocked 为 1 时 (px, py) 上额外放一个 -3 的障碍（起点终点重合的情况）
+//     query_cnt (x y v)*query_cnt              MarginGraphEngineWrap 之下的 getPos 查询与返回值
+//   FINAL xmin xmax ymin ymax neg_cnt (x y)*   布线结束后最终地图的 getBorderCoord 与 getAllNegPos
+enum class WorkloadOp: int32_t {
+    BEGIN_RUN = 1,
+    SET_LINE,
+    COMMIT_COORD_MAP,
+    SEARCH,
+    FINAL
+};
+
+enum class WorkloadLayer: int32_t {
+    TREE = 0,     // 树边与已经布好的线
+    CROSSING = 1  // 交叉点
+};
+
+class GraphWorkload {
+private:
+    static constexpr char MAGIC[4] = {'G', 'W', 'L', '1'};
+
+    std::vector<int32_t> data;
+    size_t query_cnt_at = 0; // 当前 SEARCH 记录中 query_cnt 的位置
+
+    void push(int32_t v) {
+        data.push_back(v);
+    }
+
+    void pushOp(WorkloadOp op) {
+        data.push_back((int32_t)op);
+    }
+
+public:
+    const std::vector<int32_t>& getData() const {
+        return data;
+    }
+
+    bool empty() const {
+        return data.empty();
+    }
+
+    void clear() {
+        data.clear();
+    }
+
+    void beginRun() {
+        pushOp(WorkloadOp::BEGIN_RUN);
+    }
+
+    void setLine(WorkloadLayer layer, const LineData& line) {
+        pushOp(WorkloadOp::SET_LINE);
+        push((int32_t)layer);
+        push(line.getXf()); push(line.getXt());
+        push(line.getYf()); push(line.getYt());
+        push(line.getV());
+    }
+
+    void commitCoordMap(int k) {
+        pushOp(WorkloadOp::COMMIT_COORD_MAP);
+        push(k);
+    }
+
+    // 之后的 addQuery 都属于这次搜索，直到 endSearch
+    void beginSearch(const std::vector<std::tuple<int, int>>& erase_pos,
+        const std::tuple<int, int, int, int>& border,
+        int xmin, int xmax, int ymin, int ymax, int xf, int yf, int xt, int yt,
+        bool blocked, int px, int py) {
+        pushOp(WorkloadOp::SEARCH);
+        push((int32_t)erase_pos.size());
+        for(auto [x, y]: erase_pos) {
+            push(x); push(y);
+        }
+        push(std::get<0>(border)); push(std::get<1>(border));
+        push(std::get<2>(border)); push(std::get<3>(border));
+        push(xmin); push(xmax); push(ymin); push(ymax);
+        push(xf); push(yf); push(xt); push(yt);
+        push(blocked ? 1 : 0); push(px); push(py);
+        query_cnt_at = data.size();
+        push(0);
+    }
+
+    void addQuery(int x, int y, int v) {
+        push(x); push(y); push(v);
+        data[query_cnt_at] += 1;
+    }
+
+    void endSearch() {
+        query_cnt_at = 0;
+    }
+
+    void finalGraph(const std::tuple<int, int, int, int>& border, const std::vector<std::tuple<int, int>>& neg_pos) {
+        pushOp(WorkloadOp::FINAL);
+        push(std::get<0>(border)); push(std::get<1>(border));
+        push(std::get<2>(border)); push(std::get<3>(border));
+        push((int32_t)neg_pos.size());
+        for(auto [x, y]: neg_pos) {
+            push(x); push(y);
+        }
+    }
+
+    void save(const std::string& filename) const {
+        std::ofstream fout(filename, std::ios::binary);
+        if(!fout) {
+            throw std::runtime_error("could not open " + filename + " for writing");
+        }
+        fout.write(MAGIC, sizeof(MAGIC));
+        fout.write((const char*)data.data(), (std::streamsize)(data.size() * sizeof(int32_t)));
+        if(!fout) {
+            throw std::runtime_error("failed to write " + filename);
+        }
+    }
+
+    static GraphWorkload load(const std::string& filename) {
+        std::ifstream fin(filename, std::ios::binary);
+        if(!fin) {
+            throw std::runtime_error("could not open " + filename);
+        }
+        char magic[sizeof(MAGIC)] = {};
+        fin.read(magic, sizeof(magic));
+        if(!fin || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error(filename + " is not a graph workload file");
+        }
+        std::vector<char> bytes((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        if(bytes.size() % sizeof(int32_t) != 0) {
+            throw std::runtime_error(filename + " is truncated");
+        }
+        GraphWorkload workload;
+        workload.data.resize(bytes.size() / sizeof(int32_t));
+        std::memcpy(workload.data.data(), bytes.data(), bytes.size());
+        return workload;
+    }
+};
+
+// 全局的记录开关，由 LinkAlgo 写入
+class GraphWorkloadRecorder: public EnableFlag<GraphWorkloadRecorder> {
+private:
+    inline static GraphWorkload workload;
+
+public:
+    static void enable() {
+        setEnabled(true);
+        workload.clear();
+    }
+
+    static void disable() {
+        setEnabled(false);
+    }
+
+    static GraphWorkload& get() {
+        return workload;
+    }
+
+    // 作用域内暂停记录，RecordGraphEngineWrap 的查询不写入 workload
+    class Pause {
+    private:
+        bool was_enabled;
+
+    public:
+        Pause(): was_enabled(isEnabled()) {
+            setEnabled(false);
+        }
+        ~Pause() {
+            setEnabled(was_enabled);
+        }
+        Pause(const Pause&) = delete;
+        Pause& operator=(const Pause&) = delete;
+    };
+};
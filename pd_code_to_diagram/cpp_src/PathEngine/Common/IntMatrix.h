@@ -1,45 +1,51 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <iomanip>
 #include <iostream>
+#include <string>
 
 #include "AbstractIntMatrix.h"
 #include "../../Utils/MyAssert.h"
 #include "../../BorderDetect/IntMatrix2/IntMatrix2.h"
+#include "../../BorderDetect/IntMatrix2/IntMatrix2View.h"
+#include "../../Utils/CellGrid.h"
 
 class IntMatrix: public AbstractIntMatrix {
 private:
-    std::vector<std::vector<int> > m_vec;
+    CellGrid m_vec; // 行优先连续存储，格子宽度在构造时确定
     int m_row;
     int m_col;
 
 public:
     virtual ~IntMatrix() {} // 虚析构函数
 
-    IntMatrix(int n, int m): m_row(n), m_col(m) {
-        std::vector<int> one_line;
-        for(int i = 0; i < m; i += 1) {
-            one_line.push_back(0);
-        }
-        for(int i = 0; i < n; i += 1) {
-            m_vec.push_back(one_line); // 拷贝构造
-        }
+    // 值域可以放进 int16_t 时传入 CellWidth::NARROW，见 CellGrid::chooseWidth
+    IntMatrix(int n, int m, CellWidth width = CellWidth::WIDE): m_vec(n, m, width), m_row(n), m_col(m) {}
+
+    // 只能移动，避免整张布局图被隐式拷贝
+    IntMatrix(IntMatrix&&) = default;
+    IntMatrix& operator=(IntMatrix&&) = default;
+
+    // 与 IntMatrix2 共享同一块内存的只读视图，不拷贝数据
+    // 视图使用期间当前矩阵必须保持存活
+    IntMatrix2View view() const {
+        return m_vec.visit([](auto grid) {
+            return IntMatrix2View(grid);
+        });
     }
 
-    // 赋值函数
-    IntMatrix& operator=(const IntMatrix& rhs) {
-        this -> m_vec = rhs.m_vec;
-        this -> m_row = rhs.m_row;
-        this -> m_col = rhs.m_col;
-        return (*this);
+    CellWidth getWidth() const {
+        return m_vec.getWidth();
     }
 
+    // 拷贝一份独立的 IntMatrix2
     IntMatrix2 toIntMatrix2() const {
         IntMatrix2 ans(m_row, m_col);
         for(int i = 0; i < m_row; i += 1) {
             for(int j = 0; j < m_col; j += 1) {
-                ans.setPos(i, j, getPos(i, j));
+                ans.setPos(i, j, m_vec.get(i, j));
             }
         }
         return ans;
@@ -47,7 +53,7 @@ public:
 
     virtual int getPos(int i, int j) const override {
         if(0 <= i && i < m_row && 0 <= j && j < m_col) {
-            return m_vec[i][j];
+            return m_vec.get(i, j);
         }else {
             return 0; // 出界的位置的值记为 0
         }
@@ -55,7 +61,7 @@ public:
 
     virtual void setPos(int i, int j, int v) override {
         ASSERT(0 <= i && i < m_row && 0 <= j && j < m_col);
-        m_vec[i][j] = v;
+        m_vec.set(i, j, v);
     }
 
     virtual int getRowCnt() const override {
@@ -70,6 +76,31 @@ public:
         out << std::setw(3) << std::setfill(' ') << val << " ";
     }
 
+    // 二进制输出，供 Python 端直接读入一维数组而不需要逐个解析整数
+    // 格式为 "PDDG"、行数、列数、每个格子的字节数（2 或 4），之后按行优先给出所有格子
+    // 所有整数都是小端序
+    void binaryOutput(std::ostream& out) const {
+        const int cell_bytes = (getWidth() == CellWidth::NARROW) ? 2 : 4;
+        std::string buf = "PDDG";
+        auto put = [&](uint32_t v, int bytes) {
+            for(int k = 0; k < bytes; k += 1) {
+                buf.push_back((char)((v >> (8 * k)) & 0xFF));
+            }
+        };
+        put((uint32_t)m_row, 4);
+        put((uint32_t)m_col, 4);
+        put((uint32_t)cell_bytes, 4);
+        out.write(buf.data(), (std::streamsize)buf.size());
+
+        for(int i = 0; i < m_row; i += 1) {
+            buf.clear();
+            for(int j = 0; j < m_col; j += 1) {
+                put((uint32_t)m_vec.get(i, j), cell_bytes);
+            }
+            out.write(buf.data(), (std::streamsize)buf.size());
+        }
+    }
+
     virtual void debugOutput(std::ostream& out, bool with_zero) const override {
         for(int i = 0; i < m_row; i += 1) {
             for(int j = 0; j < m_col; j += 1) {
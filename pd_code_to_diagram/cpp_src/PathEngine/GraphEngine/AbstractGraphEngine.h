@@ -50,7 +50,8 @@ public:
         exportToIntMatrix().debugOutput(out, with_zero);
     }
 
-    virtual IntMatrix exportToIntMatrix() const {
+    // width 指定导出矩阵的格子宽度，调用者需要保证所有值都能放进去
+    virtual IntMatrix exportToIntMatrix(CellWidth width = CellWidth::WIDE) const {
         int xmin, xmax, ymin, ymax;
         std::tie(xmin, xmax, ymin, ymax) = getBorderCoord();
         xmin -= 1;
@@ -58,7 +59,7 @@ public:
         ymin -= 1;
         ymax += 1;
         
-        IntMatrix ans(xmax - xmin + 1, ymax - ymin + 1);
+        IntMatrix ans(xmax - xmin + 1, ymax - ymin + 1, width);
         for(int i = xmin; i <= xmax; i += 1) {
             for(int j = ymin; j <= ymax; j += 1) {
                 ans.setPos(i - xmin, j - ymin, getPos(i, j));
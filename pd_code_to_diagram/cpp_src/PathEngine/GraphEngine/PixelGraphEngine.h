@@ -6,6 +6,7 @@
 
 #include "AbstractGraphEngine.h"
 #include "../Common/LineData.h"
+#include "../../Utils/Counters.h"
 
 class PixelGraphEngine: public AbstractGraphEngine {
 private:
@@ -17,6 +18,7 @@ public:
     static constexpr int INT_INF = 0x7fffffff;
 
     virtual int getPos(int x, int y) const override {
+        COUNTER_ADD(GETPOS_PIXEL, 1);
         auto posNow = std::make_tuple(x, y);
         if(pixelValue.find(posNow) != pixelValue.end()) {
             return pixelValue.find(posNow) -> second;
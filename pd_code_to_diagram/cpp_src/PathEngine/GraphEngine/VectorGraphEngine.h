@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 
@@ -9,6 +10,7 @@
 #include "../Common/Coord2dSet.h"
 #include "../Common/LineData.h"
 #include "../../Utils/MyAssert.h"
+#include "../../Utils/Counters.h"
 
 class VectorGraphEngine: public AbstractGraphEngine {
 private:
@@ -23,6 +25,7 @@ public:
     }
 
     virtual int getPos(int x, int y) const override {
+        COUNTER_ADD(GETPOS_VECTOR, 1);
         return pge.getPos(x, y);
     }
 
@@ -75,6 +78,8 @@ public:
 
             new_lineDataSet.push_back(new_lineData);
             new_pge.setLine(new_lineData);
+            COUNTER_ADD(COMMIT_CELLS,
+                std::abs(new_lineData.getXt() - new_lineData.getXf()) + std::abs(new_lineData.getYt() - new_lineData.getYf()) + 1);
         }
 
         // 把新的数据拷贝给内部变量
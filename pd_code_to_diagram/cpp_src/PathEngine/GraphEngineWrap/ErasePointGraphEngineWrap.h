@@ -4,6 +4,7 @@
 #include <set>
 #include "../GraphEngine/AbstractGraphEngine.h"
 #include "../../Utils/MyAssert.h"
+#include "../../Utils/Counters.h"
 
 // 在基本遵循原图的前提下
 // 强制删除几个点，保证这几个点必须返回零，其他点保持不变
@@ -36,6 +37,7 @@ public:
     }
 
     virtual int getPos(int x, int y) const override {
+        COUNTER_ADD(GETPOS_ERASE_POINT, 1);
         if(force_empty_pos.size() != 3 && force_empty_pos.size() != 4) {
             std::cerr << "warning: in ErasePointGraphEngineWrap, force_empty_pos.size() != 3 or 4" << std::endl;
             ASSERT(false);
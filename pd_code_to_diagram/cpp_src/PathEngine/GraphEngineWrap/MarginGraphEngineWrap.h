@@ -4,6 +4,7 @@
 
 #include "../GraphEngine/AbstractGraphEngine.h"
 #include "../../Utils/MyAssert.h"
+#include "../../Utils/Counters.h"
 
 // MarginGraphEngineWrap 的用途是为一个地图提供边界
 // 边界外的地方都被视为同一个值
@@ -54,6 +55,7 @@ public:
     // 可以获得一个位置的值是多少
     // 一般来说认为 0 是空气，其他数值是障碍物
     virtual int getPos(int x, int y) const override {
+        COUNTER_ADD(GETPOS_MARGIN, 1);
         if(x == xf && y == yf) { // 起始位置永远视为空气
             return 0;
         }else
@@ -4,6 +4,7 @@
 #include <set>
 #include "../GraphEngine/AbstractGraphEngine.h"
 #include "../../Utils/MyAssert.h"
+#include "../../Utils/Counters.h"
 
 // MergeGraphEngineWrap 用于合并两个抽象图引擎
 // 但是他合并后得到的抽象图引擎并不允许修改
@@ -21,6 +22,7 @@ public:
     
     // 优先使用 age_front 中的元素，除非 age_front 中没有指定其中的任何值
     virtual int getPos(int x, int y) const override {
+        COUNTER_ADD(GETPOS_MERGE, 1);
         auto front_val = age_front.getPos(x, y);
         return front_val == 0 ? age_next.getPos(x, y) : front_val;
     }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <iostream>
+
+#include "../Common/GraphWorkload.h"
+#include "../GraphEngine/AbstractGraphEngine.h"
+#include "../../Utils/MyAssert.h"
+
+// 原样转发所有查询，同时把每次 getPos 的坐标与返回值写入 GraphWorkload
+// 只在启用 GraphWorkloadRecorder 时使用
+class RecordGraphEngineWrap: public AbstractGraphEngine {
+private:
+    const AbstractGraphEngine& raw_age;
+    GraphWorkload& workload;
+
+public:
+    virtual ~RecordGraphEngineWrap(){}
+    RecordGraphEngineWrap(const AbstractGraphEngine& _raw_age, GraphWorkload& _workload):
+        raw_age(_raw_age), workload(_workload) {}
+
+    virtual int getPos(int x, int y) const override {
+        int v = raw_age.getPos(x, y);
+        if(GraphWorkloadRecorder::isEnabled()) { // 暂停时不记录
+            workload.addQuery(x, y, v);
+        }
+        return v;
+    }
+
+    virtual std::tuple<int, int, int, int> getBorderCoord() const override {
+        return raw_age.getBorderCoord();
+    }
+
+    virtual std::vector<std::tuple<int, int>> getAllNegPos() const override {
+        return raw_age.getAllNegPos();
+    }
+
+    // 不允许设置一个位置的值
+    virtual void setPos(int x, int y, int v) override {
+        std::cerr << "error: can not setPos for RecordGraphEngineWrap" << std::endl;
+        ASSERT(false);
+    }
+};
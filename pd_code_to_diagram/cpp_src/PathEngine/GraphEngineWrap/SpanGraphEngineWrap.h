@@ -6,6 +6,7 @@
 #include <vector>
 #include "../GraphEngine/AbstractGraphEngine.h"
 #include "../../Utils/MyAssert.h"
+#include "../../Utils/Counters.h"
 
 class SpanGraphEngineWrap: public AbstractGraphEngine {
 private:
@@ -16,6 +17,7 @@ public:
     SpanGraphEngineWrap(const AbstractGraphEngine& _raw_age): raw_age(_raw_age) {}
 
     virtual int getPos(int x, int y) const override {
+        COUNTER_ADD(GETPOS_SPAN, 1);
         const int dx[] = {0, 1, 0,-1};
         const int dy[] = {1, 0,-1, 0};
 
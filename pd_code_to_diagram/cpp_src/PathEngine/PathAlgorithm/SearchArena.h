@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// 最短路搜索使用的内存区域
+// 一次搜索中的所有哈希表节点与队列都从一个 monotonic_buffer_resource 中分配，搜索结束时一次性释放
+// 同一次布局尝试中的所有搜索共用一块缓冲区：某次搜索用完缓冲区以后，下一次搜索开始前会把缓冲区扩大到足够的大小
+// 因此缓冲区足够大以后，搜索过程中不会再调用 malloc
+class SearchArena {
+private:
+    // 超出缓冲区的部分直接调用全局 operator new，这样替换后的 operator new（Utils/AllocHooks.h）也能统计到
+    // 同时统计超出缓冲区的字节数
+    // （libstdc++ 的 new_delete_resource 使用 align_val_t 版本的 operator new，不会经过替换后的版本）
+    class OverflowResource: public std::pmr::memory_resource {
+    public:
+        size_t overflow_bytes = 0;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            overflow_bytes += bytes;
+            if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return ::operator new(bytes, std::align_val_t(alignment));
+            }
+            return ::operator new(bytes);
+        }
+
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+            if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::operator delete(ptr, bytes, std::align_val_t(alignment));
+            }else {
+                ::operator delete(ptr, bytes);
+            }
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    std::vector<std::byte> buffer;
+    size_t wanted_size = 0; // 下一次搜索开始前缓冲区需要达到的大小
+
+public:
+    // 第一次搜索之前缓冲区的大小
+    static constexpr size_t INITIAL_SIZE = 64 * 1024;
+
+    explicit SearchArena(size_t initial_size = INITIAL_SIZE): wanted_size(initial_size) {}
+
+    SearchArena(const SearchArena&) = delete;
+    SearchArena& operator=(const SearchArena&) = delete;
+
+    size_t getBufferSize() const {
+        return buffer.size();
+    }
+
+    // 一次搜索的作用域，离开作用域时释放这次搜索分配的所有内存
+    class Scope {
+    private:
+        SearchArena& arena;
+        OverflowResource overflow;
+        std::pmr::monotonic_buffer_resource resource;
+
+        static std::vector<std::byte>& prepare(SearchArena& arena) {
+            if(arena.buffer.size() < arena.wanted_size) {
+                arena.buffer = std::vector<std::byte>(); // 先释放旧的缓冲区，避免同时持有两块
+                arena.buffer.resize(arena.wanted_size);
+            }
+            return arena.buffer;
+        }
+
+    public:
+        explicit Scope(SearchArena& _arena):
+            arena(_arena),
+            resource(prepare(_arena).data(), _arena.buffer.size(), &overflow) {}
+
+        ~Scope() {
+            if(overflow.overflow_bytes > 0) {
+                arena.wanted_size = arena.buffer.size() + overflow.overflow_bytes;
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        std::pmr::memory_resource* get() {
+            return &resource;
+        }
+    };
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../Utils/EnableFlag.h"
+
+// 记录每次 runAlgo 的搜索范围，用于诊断布线过慢的原因
+// 启用后每次调用在输出目录中写出两张 PGM 图片以及 index.jsonl 中的一行：
+//   NNNNNN.pgm            每个格子的出队次数（四个朝向之和），最大值超过 255 时使用 16 位格式
+//   NNNNNN_obstacles.pgm  障碍物，1 表示障碍物，0 表示可以行走
+// 图片的行对应 x - xmin，列对应 y - ymin，与布局矩阵的方向一致
+class SearchHeatmap: public EnableFlag<SearchHeatmap> {
+private:
+    inline static std::string directory;
+    inline static int call_cnt = 0;
+
+    // 当前正在布线的上下文，只用于写入 index.jsonl
+    inline static unsigned int seed = 0;
+    inline static int socket_id = -1;
+
+    static std::string getPath(const std::string& name) {
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    // P5 格式，maxval 不超过 255 时每个像素一个字节，否则两个字节（大端序）
+    static void writePgm(const std::string& filename, int rows, int cols, const std::vector<uint32_t>& value, uint32_t maxval) {
+        std::ofstream fout(filename, std::ios::binary);
+        if(!fout) {
+            throw std::runtime_error("could not open " + filename + " for writing");
+        }
+        maxval = std::max<uint32_t>(1, std::min<uint32_t>(maxval, 65535));
+        fout << "P5\n" << cols << " " << rows << "\n" << maxval << "\n";
+        std::vector<unsigned char> row;
+        for(int i = 0; i < rows; i += 1) {
+            row.clear();
+            for(int j = 0; j < cols; j += 1) {
+                uint32_t v = std::min(value[(size_t)i * cols + j], maxval);
+                if(maxval > 255) {
+                    row.push_back((unsigned char)(v >> 8));
+                }
+                row.push_back((unsigned char)(v & 0xff));
+            }
+            fout.write((const char*)row.data(), (std::streamsize)row.size());
+        }
+        if(!fout) {
+            throw std::runtime_error("failed to write " + filename);
+        }
+    }
+
+public:
+    // 目录不存在时会自动创建，已有的 index.jsonl 会被清空
+    static void enable(const std::string& _directory) {
+        setEnabled(true);
+        directory = _directory;
+        call_cnt = 0;
+        std::filesystem::create_directories(directory);
+        std::ofstream fout(getPath("index.jsonl"));
+        if(!fout) {
+            throw std::runtime_error("could not open " + getPath("index.jsonl") + " for writing");
+        }
+    }
+
+    static void setSeed(unsigned int _seed) {
+        seed = _seed;
+    }
+
+    static void setSocketId(int _socket_id) {
+        socket_id = _socket_id;
+    }
+
+    // pops 与 obstacle 都是按行存储的 (xmax - xmin + 1) * (ymax - ymin + 1) 矩阵
+    static void record(int xmin, int xmax, int ymin, int ymax, int xf, int yf, int xt, int yt,
+        const std::vector<uint32_t>& pops, const std::vector<uint32_t>& obstacle) {
+
+        int rows = xmax - xmin + 1;
+        int cols = ymax - ymin + 1;
+        call_cnt += 1;
+
+        // 统计实际展开过的格子的范围，与允许的范围对比可以看出边距是否过大
+        uint64_t pop_total = 0;
+        uint32_t pop_max = 0;
+        int cells = 0, free_cells = 0;
+        int exmin = xmax, exmax = xmin, eymin = ymax, eymax = ymin;
+        for(int i = 0; i < rows; i += 1) {
+            for(int j = 0; j < cols; j += 1) {
+                uint32_t v = pops[(size_t)i * cols + j];
+                free_cells += (obstacle[(size_t)i * cols + j] == 0);
+                if(v == 0) continue;
+                pop_total += v;
+                pop_max = std::max(pop_max, v);
+                cells += 1;
+                exmin = std::min(exmin, xmin + i);
+                exmax = std::max(exmax, xmin + i);
+                eymin = std::min(eymin, ymin + j);
+                eymax = std::max(eymax, ymin + j);
+            }
+        }
+
+        std::stringstream name;
+        name << std::setw(6) << std::setfill('0') << call_cnt;
+        writePgm(getPath(name.str() + ".pgm"), rows, cols, pops, pop_max);
+        writePgm(getPath(name.str() + "_obstacles.pgm"), rows, cols, obstacle, 1);
+
+        std::ofstream fout(getPath("index.jsonl"), std::ios::app);
+        if(!fout) {
+            throw std::runtime_error("could not open " + getPath("index.jsonl") + " for writing");
+        }
+        fout << "{\"file\": \"" << name.str() << ".pgm\""
+             << ", \"obstacles\": \"" << name.str() << "_obstacles.pgm\""
+             << ", \"seed\": " << seed
+             << ", \"socket_id\": " << socket_id
+             << ", \"xmin\": " << xmin << ", \"xmax\": " << xmax
+             << ", \"ymin\": " << ymin << ", \"ymax\": " << ymax
+             << ", \"from\": [" << xf << ", " << yf << "], \"to\": [" << xt << ", " << yt << "]"
+             << ", \"pops\": " << pop_total
+             << ", \"max_pops\": " << pop_max
+             << ", \"cells\": " << cells
+             << ", \"free_cells\": " << free_cells;
+        if(cells > 0) {
+            fout << ", \"expanded\": [" << exmin << ", " << exmax << ", " << eymin << ", " << eymax << "]";
+        }
+        fout << "}" << std::endl;
+    }
+};
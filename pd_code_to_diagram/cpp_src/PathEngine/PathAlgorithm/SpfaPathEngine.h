@@ -1,19 +1,26 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <deque>
 #include <iostream>
 #include <limits>
+#include <memory_resource>
 #include <queue>
 #include <tuple>
 #include <unordered_map>
-#include <unordered_set>
 
 #include "../../Utils/Coord2dPosition.h" // 这里有方向和坐标位移的对应关系
+#include "../../Utils/Counters.h"
 #include "../../Utils/Direction.h"
 #include "../../Utils/MyAssert.h"
+#include "../../Utils/TimeBudget.h"
 
 #include "AbstractPathAlgorithm.h"
+#include "SearchArena.h"
+#include "SearchHeatmap.h"
+#include "../Common/GraphWorkload.h"
 #include "../GraphEngine/AbstractGraphEngine.h"
 #include "../GraphEngineWrap/MarginGraphEngineWrap.h"
 
@@ -32,16 +39,24 @@ namespace std {
 
 // 假设最大可以移动的坐标范围是 (0, 0) -> (N-1, M-1) 这个矩形框
 // 目前分析出大概的系统用时是 (NM / 10000) 秒
+// 搜索中的哈希表与队列都在 SearchArena 上分配，搜索结束时一次性释放
 class SpfaPathEngine: public AbstractPathAlgorithm {
 private:
     using PosType = std::tuple<int, int, Direction>; 
-    std::unordered_map<PosType,  double> dis; // 描述初始位置出发后走了多少距离
-    std::unordered_map<PosType, PosType> pre; // 描述最优前驱
-    std::unordered_set<PosType> vis;          // 描述一个元素在不在队列里
+    SearchArena* arena; // 为空时每次搜索使用一个临时的 SearchArena
 
+    struct StateInfo {
+        double  dis;      // 描述初始位置出发后走了多少距离
+        PosType pre;      // 描述最优前驱
+        bool    has_pre;  // 起点没有前驱
+        bool    in_queue; // 描述一个元素在不在队列里
+    };
+
+    // 每个状态只有四个后继：直行一格，或者原地转向其余三个方向
     using NxtInfo = std::tuple<int, int, Direction, double>;
-    std::vector<NxtInfo> getNextPos(PosType pos_at) const {
-        std::vector<NxtInfo> ans;
+    std::array<NxtInfo, 4> getNextPos(PosType pos_at) const {
+        std::array<NxtInfo, 4> ans;
+        int cnt = 0;
 
         int xnow, ynow;
         Direction dnow;
@@ -53,13 +68,13 @@ private:
 
         // 前进一个单位距离
         // 前进一格需要花费 1.0 的代价
-        ans.push_back(std::make_tuple(xnow + dx, ynow + dy, dnow, 1.0));
+        ans[cnt++] = std::make_tuple(xnow + dx, ynow + dy, dnow, 1.0);
 
         // 考虑转向
         // 转向需要花费 0.1 的代价
         for(auto dnxt: {Direction::EAST, Direction::NORTH, Direction::WEST, Direction::SOUTH}) {
             if(dnxt == dnow) continue;
-            ans.push_back(std::make_tuple(xnow, ynow, dnxt, 0.1));
+            ans[cnt++] = std::make_tuple(xnow, ynow, dnxt, 0.1);
         }
         return ans;
     }
@@ -79,6 +94,7 @@ private:
         return ans;
     }
 public:
+    explicit SpfaPathEngine(SearchArena* _arena = nullptr): arena(_arena) {}
     virtual ~SpfaPathEngine(){}
 
     virtual 
@@ -87,10 +103,6 @@ public:
         int xmin, int xmax, int ymin, int ymax,    // 限制地图的范围，超出范围的地方全视为障碍物
         int xf, int yf, int xt, int yt) override { // 标记起始位置和终止位置
 
-        // 清空距离数据结构
-        dis.clear();
-        vis.clear();
-
         // 起始位置和终止位置重合，直接就能走到，返回即可
         if(xf == xt && yf == yt) {
             std::cerr << "warning: begin and end at same point" << std::endl;
@@ -106,25 +118,42 @@ public:
         // -1: 横向在下方的交叉点
         // -2: 纵向在下方的交叉点
         auto gew = MarginGraphEngineWrap(age, xmin, xmax, ymin, ymax, -3, xf, yf, xt, yt);
+
+        // 本次搜索的所有数据结构都在 scope 结束时一起释放
+        SearchArena local_arena(0);
+        SearchArena::Scope scope(arena != nullptr ? *arena : local_arena);
+        // 距离、前驱以及是否在队列里都放在同一个表项中，每个状态只分配一次
+        std::pmr::unordered_map<PosType, StateInfo> state(scope.get());
+
+        // 记录每个格子的出队次数，只有启用 SearchHeatmap 时才分配
+        std::vector<uint32_t> heat;
+        if(SearchHeatmap::isEnabled()) {
+            heat.assign((size_t)(xmax - xmin + 1) * (ymax - ymin + 1), 0);
+        }
         
         // q 记录所有已经在 dis 中出现但还没有进行拓展的节点
-        std::queue<PosType> q;
+        std::queue<PosType, std::pmr::deque<PosType>> q{std::pmr::deque<PosType>(scope.get())};
         for(auto dir: {Direction::EAST, Direction::NORTH, Direction::WEST, Direction::SOUTH}) {
             auto pos_at = std::make_tuple(xf, yf, dir);
-            dis[pos_at] = 0;
-            vis.insert(pos_at); // vis 记录在队列中存在的元素
+            state[pos_at] = StateInfo{0, pos_at, false, true};
             q.push(pos_at);
         }
 
         while(!q.empty()) { // 使用 SPFA 跑遍全图
             auto pos_at = q.front(); q.pop();
-            vis.erase(pos_at);
+            auto& info_at = state.find(pos_at) -> second; // 哈希表的插入不会使元素的引用失效
+            info_at.in_queue = false;
+            COUNTER_ADD(SPFA_POP, 1);
+            TimeBudget::poll("spfa");
 
             // 获取当前状态信息
             auto xnow = std::get<0>(pos_at);
             auto ynow = std::get<1>(pos_at);
             auto dnow = std::get<2>(pos_at);
-            auto distance_now = dis.find(pos_at) -> second;
+            auto distance_now = info_at.dis;
+            if(!heat.empty() && xmin <= xnow && xnow <= xmax && ymin <= ynow && ynow <= ymax) {
+                heat[(size_t)(xnow - xmin) * (ymax - ymin + 1) + (ynow - ymin)] += 1;
+            }
 
             // x_y_d_v 是一个四元组，分别表示：x, y, 新的朝向, 与当前节点的距离
             for(auto x_y_d_v: getNextPos(pos_at))
@@ -138,25 +167,47 @@ public:
                     continue;
                 }
                 auto pos_nxt = std::make_tuple(xnxt, ynxt, dnxt);
-                if(dis.find(pos_nxt) == dis.end() || dis[pos_nxt] > distance_now + vnxt) {
+                auto [it_nxt, inserted] = state.try_emplace(pos_nxt);
+                bool reached = !inserted;
+                auto& info_nxt = it_nxt -> second;
+                if(!reached || info_nxt.dis > distance_now + vnxt) {
                     // 可以更新距离
-                    dis[pos_nxt] = distance_now + vnxt;
-                    pre[pos_nxt] = pos_at;
-                    if(vis.count(pos_nxt) == 0) { // 如果不在队列里
-                        vis.insert(pos_nxt);      // 把他放到队列里
+                    info_nxt.dis = distance_now + vnxt;
+                    info_nxt.pre = pos_at;
+                    info_nxt.has_pre = true;
+                    COUNTER_ADD(SPFA_RELAX, 1);
+                    if(!info_nxt.in_queue) {     // 如果不在队列里
+                        info_nxt.in_queue = true; // 把他放到队列里
                         q.push(pos_nxt);
+                        if(reached) { // 之前已经到达过且不在队列里，说明已经出过队
+                            COUNTER_ADD(SPFA_REENQUEUE, 1);
+                        }
                     }
                 }
             }
         }
 
+        if(!heat.empty()) { // 障碍物与 SPFA 看到的完全一致（包括边界外的障碍与起点终点的清空）
+            // 这些 getPos 不是搜索本身的查询，不计入 --stats 也不写入 --graph-workload
+            Counters::Pause counters_pause;
+            GraphWorkloadRecorder::Pause recorder_pause;
+            std::vector<uint32_t> obstacle(heat.size(), 0);
+            for(int x = xmin; x <= xmax; x += 1) {
+                for(int y = ymin; y <= ymax; y += 1) {
+                    obstacle[(size_t)(x - xmin) * (ymax - ymin + 1) + (y - ymin)] = (gew.getPos(x, y) != 0);
+                }
+            }
+            SearchHeatmap::record(xmin, xmax, ymin, ymax, xf, yf, xt, yt, heat, obstacle);
+        }
+
         double dis_now = std::numeric_limits<double>::infinity(); // 正无穷
         PosType pos_now = std::make_tuple(xt, yt, Direction::EAST);
         for(auto dir: {Direction::EAST, Direction::NORTH, Direction::WEST, Direction::SOUTH}) {
             PosType pos = std::make_tuple(xt, yt, dir);
-            if(dis.find(pos) != dis.end()) {            // 位置可达
-                if(dis.find(pos) -> second < dis_now) { // 更新最优位置
-                    dis_now = dis.find(pos) -> second;
+            auto it = state.find(pos);
+            if(it != state.end()) {              // 位置可达
+                if(it -> second.dis < dis_now) { // 更新最优位置
+                    dis_now = it -> second.dis;
                     pos_now = pos;
                 }
             }
@@ -171,15 +222,16 @@ public:
         std::vector<PosType> arr;
         while(true) {
             arr.push_back(pos_now);
-            if(pre.find(pos_now) == pre.end()) { // 没有前驱了
+            const auto& info_now = state.find(pos_now) -> second;
+            if(!info_now.has_pre) { // 没有前驱了
                 break;
             }else {
-                pos_now = pre[pos_now]; // 获得前驱节点
+                pos_now = info_now.pre; // 获得前驱节点
             }
         }
         std::reverse(arr.begin(), arr.end()); // 反转这个序列
         ASSERT(arr.size() >= 1);
         return std::make_tuple(
-            dis[old_pos_now], getVecLineData(arr)); // 从途径点上的信息合并得到最终的路径
+            state.find(old_pos_now) -> second.dis, getVecLineData(arr)); // 从途径点上的信息合并得到最终的路径
     }
 };
@@ -6,30 +6,71 @@
 #include "BorderDetect/BorderDetect.h"
 #include "BorderDetect/Graph/ConnectedComponents.h"
 #include "BorderDetect/Graph/Graph.h"
+#include "BorderDetect/OuterFaceDetect.h"
 #include "PathEngine/Common/IntMatrix.h"
-#include "PdTreeAlgo/PDCode.h"
-#include "PdTreeAlgo/PDTree.h"
+#include "PathEngine/PathAlgorithm/SearchHeatmap.h"
+#include "PDTreeAlgo/PDCode.h"
+#include "PDTreeAlgo/PDTree.h"
+#include "Utils/AllocStats.h"
+#include "Utils/AttemptLog.h"
 #include "Utils/Debug.h"
+#include "Utils/Counters.h"
 #include "Utils/Exceptions.h"
+#include "Utils/PrecisionTimer.h"
+#include "Utils/Profiler.h"
 #include "Utils/Random.h"
 #include "Utils/StringStream.h"
+#include "Utils/TimeBudget.h"
 #include "LinkAlgo.h"
 
 class PdToDiagram2d {
 public:
+    // 标记需要位于最外圈的连通分支中的所有编号
+    // last_socket_id = -1 表示最大编号所在的连通分支
+    static std::vector<char> getTargetComponentMask(const PDCode& pd_code, int last_socket_id) {
+        int max_label = 0;
+        for(int i = 0; i < pd_code.getCrossingNumber(); i += 1) {
+            for(int label: pd_code.getCrossing(i).getRaw()) {
+                max_label = std::max(max_label, label);
+            }
+        }
+        int lastv = last_socket_id > 0 ? last_socket_id : max_label;
+
+        // 不存在的编号对应空集，此时边界检查总是失败，与 checkBorderMaxCC 一致
+        std::vector<char> in_target(max_label + 1, 0);
+        if(pd_code.getGraphNext().count(lastv) == 0) {
+            return in_target;
+        }
+        for(int label: pd_code.getComponent(lastv)) {
+            if(0 < label && label <= max_label) {
+                in_target[label] = 1;
+            }
+        }
+        return in_target;
+    }
+
+    // record 不为空时记录树形图的生成次数以及达到的网格大小（抛出异常之前同样会记录）
+    // need_matrix = false 表示调用者只用到线段图，此时通过稀疏检查之后不再导出稠密矩阵，返回的矩阵只是占位
     virtual std::tuple<LinkAlgo, IntMatrix> tryConvertOnce(
         unsigned int seed,
         int last_socket_id,
-        std::stringstream& pd_code_ss
+        std::stringstream& pd_code_ss,
+        AttemptRecord* record = nullptr,
+        bool need_matrix = true
     ) const {
         
         // 重置随机种子
         myrandom::setSeed(seed);
+        SearchHeatmap::setSeed(seed);
+        PROFILE_PHASE_ARG("attempt", "seed", seed);
 
         SHOW_DEBUG_MESSAGE("input pd_code ...");
         PDCode pd_code;
-        if(!pd_code.InputPdCode(pd_code_ss)) {
-            throw std::invalid_argument("invalid PD code");
+        {
+            PROFILE_PHASE("parse_pd_code");
+            if(!pd_code.InputPdCode(pd_code_ss)) {
+                throw std::invalid_argument("invalid PD code");
+            }
         }
 
         SHOW_DEBUG_MESSAGE("generating pd_tree ...");
@@ -38,65 +79,166 @@ public:
         // 生成树形图直到没有交叉点重叠
         bool tree_ready = false;
         for(int tree_attempt = 0; tree_attempt < 1000; tree_attempt += 1) {
+            TimeBudget::check("pd_tree");
+            PROFILE_PHASE_ARG("pd_tree", "tree_attempt", tree_attempt);
+            ALLOC_SCOPE(TREE);
+            if(record != nullptr) {
+                record->tree_attempts = tree_attempt + 1;
+            }
             pd_tree.clear();
             pd_tree.load(pd_code, last_socket_id); // 生成树形图
             if(pd_tree.checkNoOverlay()) {
                 tree_ready = true;
                 break;
             }
+            COUNTER_ADD(PDTREE_RESTART, 1);
         }
         if(!tree_ready) {
+            COUNTER_ADD(EXC_CROSSING_MEET, 1);
             THROW_EXCEPTION(CrossingMeetException, "could not place a non-overlapping tree");
         }
 
         SHOW_DEBUG_MESSAGE("generating and checking socket_info ...");
-        SocketInfo s_info = pd_tree.getSocketInfo(); // 生成完全的插头信息
+        SocketInfo s_info;
         int component_cnt = pd_tree.getComponentCnt();
-        s_info.check(pd_code.getCrossingNumber(), component_cnt);   // 检查信息合法性
+        {
+            PROFILE_PHASE("socket_info");
+            ALLOC_SCOPE(TREE);
+            s_info = pd_tree.getSocketInfo(); // 生成完全的插头信息
+            s_info.check(pd_code.getCrossingNumber(), component_cnt);   // 检查信息合法性
+        }
 
         SHOW_DEBUG_MESSAGE("running link algo ...");
-        LinkAlgo link_algo(pd_code.getCrossingNumber(), s_info, component_cnt);
-        auto im = link_algo.getFinalGraph().exportToIntMatrix();
+        auto link_algo = [&]() {
+            PROFILE_PHASE("link_algo");
+            ALLOC_SCOPE(ROUTING);
+            return LinkAlgo(pd_code.getCrossingNumber(), s_info, component_cnt);
+        }();
 
         // 检查最大编号所在的连通分支是否在最外圈
+        // 先在线段图上沿外部面行走，只有通过检查的布局才需要生成稠密矩阵
         SHOW_DEBUG_MESSAGE("checking border ...");
-        auto im2 = im.toIntMatrix2();
-        auto detector = BorderDetect();
-        auto detector_flag = detector.checkBorderMaxCC(last_socket_id, im2);
+        auto in_target = getTargetComponentMask(pd_code, last_socket_id);
+        auto sparse_flag = [&]() {
+            PROFILE_PHASE("check_border_sparse");
+            ALLOC_SCOPE(BORDER);
+            return OuterFaceDetect::check(link_algo.getAllEdges(), in_target, component_cnt);
+        }();
+        auto recordGridSize = [&]() {
+            if(record != nullptr) { // 与 exportToIntMatrix 相同，四周各留出一格
+                int xmin, xmax, ymin, ymax;
+                std::tie(xmin, xmax, ymin, ymax) = link_algo.getFinalGraph().getBorderCoord();
+                record->rows = xmax - xmin + 3;
+                record->cols = ymax - ymin + 3;
+            }
+        };
+        if(sparse_flag == OuterFaceResult::FAIL && !DEBUG) {
+            recordGridSize();
+            COUNTER_ADD(EXC_BAD_BORDER, 1);
+            THROW_EXCEPTION(BadBorderException, "");
+        }
+        if(sparse_flag == OuterFaceResult::PASS && !need_matrix && !DEBUG) {
+            recordGridSize();
+            return std::make_tuple(std::move(link_algo), IntMatrix(1, 1));
+        }
+
+        // 格子中只有 -2 到最大编号之间的值，通常可以用 16 位整数存储
+        auto im = [&]() {
+            PROFILE_PHASE("export_matrix");
+            ALLOC_SCOPE(OUTPUT);
+            return link_algo.getFinalGraph().exportToIntMatrix(CellGrid::chooseWidth(-2, (int)in_target.size() - 1));
+        }();
+        if(record != nullptr) {
+            record->rows = im.getRowCnt();
+            record->cols = im.getColCnt();
+        }
+        bool detector_flag = (sparse_flag == OuterFaceResult::PASS);
+        if(sparse_flag == OuterFaceResult::UNKNOWN || DEBUG) {
+            PROFILE_PHASE("check_border_dense");
+            ALLOC_SCOPE(BORDER);
+            auto im2 = im.view();
+            auto detector = BorderDetect();
+            detector_flag = im2.visit([&](auto grid) {
+                return detector.checkBorderFused(grid, in_target);
+            });
+
+            // 调试模式下与原始的矩阵流水线对比结果
+            if(DEBUG) {
+                ASSERT(detector_flag == detector.checkBorderMaxCC(last_socket_id, im2));
+                if(sparse_flag != OuterFaceResult::UNKNOWN) {
+                    ASSERT(detector_flag == (sparse_flag == OuterFaceResult::PASS));
+                }
+            }
+        }
 
         // 检查布局算法是否成功
         if(!detector_flag) {
+            COUNTER_ADD(EXC_BAD_BORDER, 1);
             THROW_EXCEPTION(BadBorderException, "");
         }
 
         // 返回计算得到的 matrix
-        return std::make_tuple(link_algo, im);
+        return std::make_tuple(std::move(link_algo), std::move(im));
     }
 
     // last_socket_id 用于给出哪个连通分支应该位于最外侧
     // last_socket_id = -1 表示让最大编号元素在最外圈
+    // seeds_tried 不为空时记录实际尝试过的随机种子个数（包括成功的那一个）
+    // 每个种子的结果都会写入 AttemptLog
+    // need_matrix 的含义与 tryConvertOnce 相同
     virtual std::tuple<LinkAlgo, IntMatrix> convert(
         unsigned int min_seed, 
         int last_socket_id,
         std::stringstream& pd_code_ss,
-        int max_try = 100
+        int max_try = 100,
+        int* seeds_tried = nullptr,
+        bool need_matrix = true
     ) const {
         auto ans = std::make_tuple(LinkAlgo(), IntMatrix(1, 1));
 
         bool fail = true;
         bool suc = false;
         for(unsigned int seed = min_seed; seed <= min_seed + max_try; seed += 1) {
+            TimeBudget::check("seed_loop"); // 超时时不再开始新的种子，也不记录这个种子
+            if(seeds_tried != nullptr) {
+                *seeds_tried = (int)(seed - min_seed) + 1;
+            }
+            COUNTER_ADD(SEEDS_TRIED, 1);
+
+            AttemptRecord record;
+            record.seed = seed;
+            record.last_socket_id = last_socket_id;
+            PrecisionTimer timer;
+            timer.start();
             try{
                 REWIND_STRING_STREAM(pd_code_ss);
 
                 // 赋值函数
-                ans = tryConvertOnce(seed, last_socket_id, pd_code_ss);
+                ans = tryConvertOnce(seed, last_socket_id, pd_code_ss, &record, need_matrix);
 
                 fail = false; // 没有失败
                 suc = true;   // 成功了
+                record.outcome = AttemptOutcome::SUCCESS;
+            }
+            PROCESS_EXCEPTION(CrossingMeetException, fail = true; record.outcome = AttemptOutcome::TREE_OVERLAP)
+            PROCESS_EXCEPTION(BadBorderException, fail = true; record.outcome = AttemptOutcome::BAD_BORDER)
+            catch(const std::runtime_error&) { // ASSERT 失败，记录之后继续抛出
+                timer.stop();
+                record.outcome = AttemptOutcome::ROUTING_ASSERT;
+                record.ms = timer.get_elapsed_ms();
+                AttemptLog::add(record);
+                throw;
+            }
+            catch(const TimeBudgetExceeded&) { // 超时，记录之后继续抛出
+                timer.stop();
+                record.outcome = AttemptOutcome::TIMEOUT;
+                record.ms = timer.get_elapsed_ms();
+                AttemptLog::add(record);
+                throw;
             }
-            PROCESS_EXCEPTION(CrossingMeetException, fail = true)
-            PROCESS_EXCEPTION(BadBorderException, fail = true)
+            timer.stop();
+            record.ms = timer.get_elapsed_ms();
+            AttemptLog::add(record);
 
             if(!fail) { //  如果没失败就退出
                 break;
@@ -110,13 +252,14 @@ public:
                 + std::to_string(max_try) + std::string(" try."));
 
             // 抛出最大尝试超过异常
+            COUNTER_ADD(EXC_MAX_TRY, 1);
             THROW_EXCEPTION(MaxTryExceeded, "");
         }
         return ans;
     }
 
     // 给定一个 pd_code，计算其中的所有连通分支
-    virtual std::vector<std::set<int>> getAllCc(std::stringstream& pd_code_ss) const {
+    virtual ComponentLabels getAllCc(std::stringstream& pd_code_ss) const {
         PDCode pd_code;
         if(!pd_code.InputPdCode(pd_code_ss)) {
             throw std::invalid_argument("invalid PD code");
@@ -135,7 +278,6 @@ public:
 
         // 计算所有连通分支
         auto cc_alg = ConnectedComponents(node_graph);
-        auto all_cc = cc_alg.getConnectedComponents();
-        return all_cc;
+        return cc_alg.getComponentLabels();
     }
 };
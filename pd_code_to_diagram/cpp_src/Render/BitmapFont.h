@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+
+#include "RgbImage.h"
+
+// 一个只包含数字的 3x5 点阵字体，用于在图片上标注 socket 编号
+// 这样渲染器不需要依赖任何字体文件
+class BitmapFont {
+private:
+    static constexpr int GLYPH_W = 3;
+    static constexpr int GLYPH_H = 5;
+
+    // 每个数字五行，每行低三位从左到右描述像素
+    static const unsigned char* getGlyph(char ch) {
+        static const unsigned char glyphs[10][GLYPH_H] = {
+            {7, 5, 5, 5, 7}, // 0
+            {2, 6, 2, 2, 7}, // 1
+            {7, 1, 7, 4, 7}, // 2
+            {7, 1, 7, 1, 7}, // 3
+            {5, 5, 7, 1, 1}, // 4
+            {7, 4, 7, 1, 7}, // 5
+            {7, 4, 7, 5, 7}, // 6
+            {7, 1, 1, 1, 1}, // 7
+            {7, 5, 7, 5, 7}, // 8
+            {7, 5, 7, 1, 7}, // 9
+        };
+        if(ch < '0' || ch > '9') return nullptr;
+        return glyphs[ch - '0'];
+    }
+
+    int scale;
+
+public:
+    // font_size 是文字的目标像素高度
+    explicit BitmapFont(int font_size): scale(font_size / GLYPH_H > 0 ? font_size / GLYPH_H : 1) {}
+
+    int textWidth(const std::string& text) const {
+        if(text.empty()) return 0;
+        return ((int)text.size() * (GLYPH_W + 1) - 1) * scale;
+    }
+
+    int textHeight() const {
+        return GLYPH_H * scale;
+    }
+
+    // 以 (x, y) 为左上角绘制文字
+    void draw(RgbImage& image, int x, int y, const std::string& text,
+        uint8_t r, uint8_t g, uint8_t b) const {
+        for(char ch: text) {
+            const unsigned char* glyph = getGlyph(ch);
+            if(glyph != nullptr) {
+                for(int gy = 0; gy < GLYPH_H; gy += 1) {
+                    for(int gx = 0; gx < GLYPH_W; gx += 1) {
+                        if(!((glyph[gy] >> (GLYPH_W - 1 - gx)) & 1)) continue;
+                        for(int sy = 0; sy < scale; sy += 1) {
+                            for(int sx = 0; sx < scale; sx += 1) {
+                                image.setPixel(x + gx * scale + sx, y + gy * scale + sy, r, g, b);
+                            }
+                        }
+                    }
+                }
+            }
+            x += (GLYPH_W + 1) * scale;
+        }
+    }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "BitmapFont.h"
+#include "PngWriter.h"
+#include "RgbImage.h"
+#include "../BorderDetect/IntMatrix2/AbstractIntMatrix2.h"
+#include "../Utils/Exceptions.h"
+#include "../Utils/MyAssert.h"
+
+// 把二维布局矩阵渲染成图片
+// 与 Python 端的 to_image.py 保持一致：每个格子对应一个 tile_size x tile_size 的贴图
+// 贴图在第一次使用时计算一次，之后只做整块复制
+class DiagramRenderer {
+public:
+    static constexpr int DEFAULT_TILE_SIZE = 30;
+
+    // 线段贴图的编号与 to_image.py 中的 mask 一致
+    // 1: 上, 2: 右, 4: 下, 8: 左
+    static constexpr int MASK_TOP    = 1;
+    static constexpr int MASK_RIGHT  = 2;
+    static constexpr int MASK_BOTTOM = 4;
+    static constexpr int MASK_LEFT   = 8;
+
+    // 计算一个格子应该使用的贴图编号
+    // 0 表示空白，-1 和 -2 表示两种交叉点，正数表示线段的连接方向
+    static int tileCodeForCell(const AbstractIntMatrix2& aim, int i, int j) {
+        int val = aim.getPos(i, j);
+        if(val == 0 || val == -1 || val == -2) {
+            return val;
+        }
+        if(val < 0) {
+            THROW_EXCEPTION(BadDiagramException, "unsupported crossing value " + std::to_string(val)
+                + " at (" + std::to_string(i) + ", " + std::to_string(j) + ")");
+        }
+
+        static const int di[] = {-1, 0, 1,  0};
+        static const int dj[] = { 0, 1, 0, -1};
+        int mask = 0;
+        for(int d = 0; d < 4; d += 1) {
+            int ni = i + di[d];
+            int nj = j + dj[d];
+            if(0 <= ni && ni < aim.getRcnt() && 0 <= nj && nj < aim.getCcnt()) {
+                int neighbor = aim.getPos(ni, nj);
+                if(neighbor == val || neighbor < 0) {
+                    mask |= (1 << d);
+                }
+            }
+        }
+        if(!isLineMask(mask)) {
+            THROW_EXCEPTION(BadDiagramException, "line value " + std::to_string(val)
+                + " at (" + std::to_string(i) + ", " + std::to_string(j)
+                + ") needs unsupported tile " + std::to_string(mask));
+        }
+        return mask;
+    }
+
+    static bool isLineMask(int mask) {
+        return mask == 3 || mask == 5 || mask == 6 || mask == 9 || mask == 10 || mask == 12;
+    }
+
+private:
+    int tile_size;
+    bool show_labels;
+    double line_width;
+
+    // 贴图缓存，下标由 tileIndex 给出
+    std::vector<RgbImage> tiles;
+
+    static int tileIndex(int code) {
+        switch(code) {
+            case  0: return 0;
+            case  3: return 1;
+            case  5: return 2;
+            case  6: return 3;
+            case  9: return 4;
+            case 10: return 5;
+            case 12: return 6;
+            case -1: return 7;
+            case -2: return 8;
+        }
+        ASSERT(false);
+        return -1;
+    }
+
+    // 计算宽度为 line_width、中心在 c 的线带覆盖像素 [p, p + 1] 的比例
+    double bandCoverage(double p, double c) const {
+        double lo = std::max(p, c - line_width / 2);
+        double hi = std::min(p + 1, c + line_width / 2);
+        return std::max(0.0, hi - lo);
+    }
+
+    // 圆弧（或圆盘边界）按照像素中心到曲线的距离做抗锯齿
+    static double edgeCoverage(double signed_distance) {
+        return std::min(1.0, std::max(0.0, 0.5 - signed_distance));
+    }
+
+    RgbImage drawTile(int code) const {
+        const double n = tile_size;
+        const double mid = n / 2;
+        RgbImage tile(tile_size, tile_size);
+
+        for(int y = 0; y < tile_size; y += 1) {
+            for(int x = 0; x < tile_size; x += 1) {
+                double px = x + 0.5;
+                double py = y + 0.5;
+                double vertical   = bandCoverage(x, mid); // 竖直线
+                double horizontal = bandCoverage(y, mid); // 水平线
+                double ink = 0;
+
+                if(code == 5) {
+                    ink = vertical;
+                }else if(code == 10) {
+                    ink = horizontal;
+                }else if(code > 0) {
+                    // 拐角使用以格子角点为圆心、半径为 n / 2 的四分之一圆弧
+                    double cx = (code & MASK_RIGHT ) ? n : 0;
+                    double cy = (code & MASK_BOTTOM) ? n : 0;
+                    double dist = std::hypot(px - cx, py - cy);
+                    ink = edgeCoverage(std::abs(dist - mid) - line_width / 2);
+                }else if(code < 0) {
+                    // 先画下方的线，再挖去中心的圆盘，最后画上方的线
+                    double under = (code == -1) ? vertical : horizontal;
+                    double over  = (code == -1) ? horizontal : vertical;
+                    double gap = edgeCoverage(std::hypot(px - mid, py - mid) - 1.5 * line_width);
+                    under *= (1 - gap);
+                    ink = 1 - (1 - under) * (1 - over);
+                }
+
+                uint8_t v = (uint8_t)std::lround(255 * (1 - std::min(1.0, ink)));
+                tile.setPixel(x, y, v, v, v);
+            }
+        }
+        return tile;
+    }
+
+    const RgbImage& getTile(int code) {
+        if(tiles.empty()) {
+            for(int c: {0, 3, 5, 6, 9, 10, 12, -1, -2}) {
+                tiles.push_back(drawTile(c));
+            }
+        }
+        return tiles[tileIndex(code)];
+    }
+
+    // 在每个交叉点周围的四个格子上标出 socket 编号，位置规则与 to_image.py 相同
+    // 只处理第 row_begin 到 row_end - 1 行中的交叉点，image 的第 0 行对应整张图的第 y0 行
+    void drawSocketLabels(RgbImage& image, const AbstractIntMatrix2& aim, int row_begin, int row_end, int y0) const {
+        const int font_size = std::max(7, tile_size / 3);
+        const int margin = std::max(2, tile_size / 10);
+        BitmapFont font(font_size);
+
+        // 上方和左侧的邻居把编号写在右下角，右侧和下方的邻居写在左上角
+        static const int di[]          = {-1, 0, 1,  0};
+        static const int dj[]          = { 0, 1, 0, -1};
+        static const bool right_down[] = {true, false, false, true};
+
+        for(int i = std::max(0, row_begin); i < std::min(aim.getRcnt(), row_end); i += 1) {
+            for(int j = 0; j < aim.getCcnt(); j += 1) {
+                int center = aim.getPos(i, j);
+                if(center != -1 && center != -2) continue;
+
+                for(int d = 0; d < 4; d += 1) {
+                    int ni = i + di[d];
+                    int nj = j + dj[d];
+                    if(!(0 <= ni && ni < aim.getRcnt() && 0 <= nj && nj < aim.getCcnt())) continue;
+                    int val = aim.getPos(ni, nj);
+                    if(val <= 0) continue;
+
+                    auto text = std::to_string(val);
+                    int x, y;
+                    if(right_down[d]) {
+                        x = (nj + 1) * tile_size - margin - font.textWidth(text);
+                        y = (ni + 1) * tile_size - margin - font.textHeight();
+                    }else {
+                        x = nj * tile_size + margin;
+                        y = ni * tile_size + margin;
+                    }
+                    font.draw(image, x, y - y0, text, 220, 0, 0);
+                }
+            }
+        }
+    }
+
+public:
+    DiagramRenderer(int _tile_size = DEFAULT_TILE_SIZE, bool _show_labels = false):
+        tile_size(_tile_size), show_labels(_show_labels) {
+        if(tile_size <= 0) {
+            throw std::invalid_argument("tile size must be positive");
+        }
+        line_width = std::max(1.0, std::round(tile_size * 4.0 / DEFAULT_TILE_SIZE));
+    }
+
+    // 按格子的行分条渲染，每一条的高度为 tile_size，依次调用 func(strip, y0)
+    // y0 是这一条在整张图中的起始像素行，同一时刻只有一条存在于内存中
+    template<typename Func>
+    void renderStrips(const AbstractIntMatrix2& aim, Func&& func) {
+        RgbImage strip(aim.getCcnt() * tile_size, tile_size);
+        for(int i = 0; i < aim.getRcnt(); i += 1) {
+            for(int j = 0; j < aim.getCcnt(); j += 1) {
+                strip.paste(getTile(tileCodeForCell(aim, i, j)), j * tile_size, 0);
+            }
+
+            // 编号写在交叉点的邻居格子里，只有相邻三行中的交叉点会画到这一条上
+            if(show_labels) {
+                drawSocketLabels(strip, aim, i - 1, i + 2, i * tile_size);
+            }
+            func((const RgbImage&)strip, i * tile_size);
+        }
+    }
+
+    RgbImage render(const AbstractIntMatrix2& aim) {
+        RgbImage image(aim.getCcnt() * tile_size, aim.getRcnt() * tile_size);
+        renderStrips(aim, [&](const RgbImage& strip, int y0) {
+            image.paste(strip, 0, y0);
+        });
+        return image;
+    }
+
+    // 逐条写入 PNG，峰值内存只与一条的大小有关
+    void renderToPng(const AbstractIntMatrix2& aim, const std::string& filename) {
+        PngWriter writer(filename, aim.getCcnt() * tile_size, aim.getRcnt() * tile_size);
+        renderStrips(aim, [&](const RgbImage& strip, int) {
+            for(int y = 0; y < strip.getHeight(); y += 1) {
+                writer.writeRow(strip.rowData(y));
+            }
+        });
+        writer.finish();
+    }
+
+    void renderToPpm(const AbstractIntMatrix2& aim, const std::string& filename) {
+        PpmWriter writer(filename, aim.getCcnt() * tile_size, aim.getRcnt() * tile_size);
+        renderStrips(aim, [&](const RgbImage& strip, int) {
+            for(int y = 0; y < strip.getHeight(); y += 1) {
+                writer.writeRow(strip.rowData(y));
+            }
+        });
+        writer.finish();
+    }
+};
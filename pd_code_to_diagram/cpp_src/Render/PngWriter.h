@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "RgbImage.h"
+#include "../Utils/MyAssert.h"
+
+// 一个不依赖 zlib 的小型 PNG 编码器
+// 压缩部分使用固定 Huffman 表的 deflate 以及基于哈希链的 LZ77 匹配
+// 对于大片白色背景的扭结图，压缩率已经足够好
+
+// 计算 PNG chunk 所需的 CRC32
+class Crc32 {
+private:
+    static const uint32_t* getTable() {
+        static uint32_t table[256];
+        static bool ready = false;
+        if(!ready) {
+            for(uint32_t n = 0; n < 256; n += 1) {
+                uint32_t c = n;
+                for(int k = 0; k < 8; k += 1) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                table[n] = c;
+            }
+            ready = true;
+        }
+        return table;
+    }
+
+public:
+    static uint32_t update(uint32_t crc, const uint8_t* data, size_t len) {
+        const uint32_t* table = getTable();
+        uint32_t c = crc ^ 0xFFFFFFFFu;
+        for(size_t i = 0; i < len; i += 1) {
+            c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+        }
+        return c ^ 0xFFFFFFFFu;
+    }
+};
+
+// 计算 zlib 数据流尾部所需的 Adler32
+class Adler32 {
+private:
+    uint32_t a = 1;
+    uint32_t b = 0;
+
+public:
+    void update(const uint8_t* data, size_t len) {
+        static const uint32_t MOD = 65521;
+        while(len > 0) {
+            size_t block = len < 5552 ? len : 5552; // 保证 b 不会溢出
+            len -= block;
+            for(size_t i = 0; i < block; i += 1) {
+                a += data[i];
+                b += a;
+            }
+            data += block;
+            a %= MOD;
+            b %= MOD;
+        }
+    }
+
+    uint32_t value() const {
+        return (b << 16) | a;
+    }
+};
+
+// 流式的 zlib (deflate) 压缩器
+// 可以分多次调用 write 写入数据，最后调用 finish 结束数据流
+// 压缩结果会追加到 out 中，调用方可以随时取走 out 中的内容
+class DeflateEncoder {
+private:
+    static constexpr int WSIZE       = 32768; // deflate 规定的最大回看距离
+    static constexpr int MIN_MATCH   = 3;
+    static constexpr int MAX_MATCH   = 258;
+    static constexpr int HASH_BITS   = 15;
+    static constexpr int HASH_SIZE   = 1 << HASH_BITS;
+    static constexpr int MAX_CHAIN   = 48;    // 哈希链最多检查多少个候选位置
+
+    std::string& out;
+    uint32_t bit_buf = 0;
+    int bit_cnt = 0;
+
+    // data[0] 对应全局位置 data_start
+    // pending 是下一个还没有被编码的全局位置
+    std::vector<uint8_t> data;
+    int64_t data_start = 0;
+    int64_t pending = 0;
+
+    std::vector<int64_t> head; // 哈希值 -> 最近一次出现的全局位置
+    std::vector<int64_t> prev; // 全局位置 % WSIZE -> 上一个相同哈希值的位置
+
+    Adler32 adler;
+    bool finished = false;
+
+    void putBits(uint32_t value, int n) {
+        bit_buf |= value << bit_cnt;
+        bit_cnt += n;
+        while(bit_cnt >= 8) {
+            out.push_back((char)(bit_buf & 0xFF));
+            bit_buf >>= 8;
+            bit_cnt -= 8;
+        }
+    }
+
+    // Huffman 编码需要高位在前写入
+    void putCode(uint32_t code, int len) {
+        uint32_t rev = 0;
+        for(int i = 0; i < len; i += 1) {
+            rev = (rev << 1) | ((code >> i) & 1);
+        }
+        putBits(rev, len);
+    }
+
+    void putLiteral(int v) {
+        if(v <= 143) {
+            putCode(0x30 + v, 8);
+        }else if(v <= 255) {
+            putCode(0x190 + (v - 144), 9);
+        }else if(v <= 279) {
+            putCode(v - 256, 7);
+        }else {
+            putCode(0xC0 + (v - 280), 8);
+        }
+    }
+
+    void putMatch(int len, int dist) {
+        static const int len_base[] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int len_extra[] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const int dist_base[] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+            8193, 12289, 16385, 24577};
+        static const int dist_extra[] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        int lc = 28;
+        while(len_base[lc] > len) lc -= 1;
+        putLiteral(257 + lc);
+        putBits(len - len_base[lc], len_extra[lc]);
+
+        int dc = 29;
+        while(dist_base[dc] > dist) dc -= 1;
+        putCode(dc, 5);
+        putBits(dist - dist_base[dc], dist_extra[dc]);
+    }
+
+    uint8_t at(int64_t pos) const {
+        return data[(size_t)(pos - data_start)];
+    }
+
+    int hashAt(int64_t pos) const {
+        uint32_t v = ((uint32_t)at(pos) << 16) | ((uint32_t)at(pos + 1) << 8) | at(pos + 2);
+        return (int)((v * 2654435761u) >> (32 - HASH_BITS));
+    }
+
+    void insertHash(int64_t pos, int64_t end) {
+        if(pos + MIN_MATCH > end) return;
+        int h = hashAt(pos);
+        prev[(size_t)(pos % WSIZE)] = head[h];
+        head[h] = pos;
+    }
+
+    // 压缩 [pending, end) 中的数据，但是要为匹配保留 keep 字节的前瞻
+    void compress(int64_t end, int64_t keep) {
+        while(pending + keep < end || (keep == 0 && pending < end)) {
+            int best_len = 0;
+            int64_t best_pos = -1;
+            int max_len = (int)std::min<int64_t>(MAX_MATCH, end - pending);
+
+            if(max_len >= MIN_MATCH) {
+                int64_t cand = head[hashAt(pending)];
+                for(int chain = 0; chain < MAX_CHAIN && cand >= 0; chain += 1) {
+                    if(cand < data_start || pending - cand > WSIZE || cand >= pending) break;
+                    int l = 0;
+                    while(l < max_len && at(cand + l) == at(pending + l)) l += 1;
+                    if(l > best_len) {
+                        best_len = l;
+                        best_pos = cand;
+                        if(l == max_len) break;
+                    }
+                    int64_t nxt = prev[(size_t)(cand % WSIZE)];
+                    if(nxt >= cand) break; // 链表已经被新数据覆盖
+                    cand = nxt;
+                }
+            }
+
+            if(best_len >= MIN_MATCH) {
+                putMatch(best_len, (int)(pending - best_pos));
+                for(int i = 0; i < best_len; i += 1) {
+                    insertHash(pending + i, end);
+                }
+                pending += best_len;
+            }else {
+                putLiteral(at(pending));
+                insertHash(pending, end);
+                pending += 1;
+            }
+        }
+
+        // 丢弃已经超出回看窗口的数据，保持内存占用有界
+        int64_t keep_from = pending - WSIZE;
+        if(keep_from - data_start > 4 * WSIZE) {
+            data.erase(data.begin(), data.begin() + (size_t)(keep_from - data_start));
+            data_start = keep_from;
+        }
+    }
+
+public:
+    explicit DeflateEncoder(std::string& _out): out(_out), head(HASH_SIZE, -1), prev(WSIZE, -1) {
+        out.push_back((char)0x78); // zlib 头：deflate, 32K 窗口
+        out.push_back((char)0x01);
+        putBits(0, 1);             // BFINAL = 0，最后会补上一个空的结束块
+        putBits(1, 2);             // BTYPE = 01，固定 Huffman 表
+    }
+
+    void write(const uint8_t* buf, size_t len) {
+        ASSERT(!finished);
+        adler.update(buf, len);
+        data.insert(data.end(), buf, buf + len);
+        compress(data_start + (int64_t)data.size(), MAX_MATCH);
+    }
+
+    void finish() {
+        ASSERT(!finished);
+        compress(data_start + (int64_t)data.size(), 0);
+        putLiteral(256);  // 当前块结束
+        putBits(1, 1);    // BFINAL = 1
+        putBits(1, 2);    // BTYPE = 01
+        putLiteral(256);  // 空的最终块
+        if(bit_cnt > 0) putBits(0, 8 - bit_cnt);
+
+        uint32_t v = adler.value();
+        for(int s = 24; s >= 0; s -= 8) {
+            out.push_back((char)((v >> s) & 0xFF));
+        }
+        finished = true;
+    }
+};
+
+// 逐行写入 PNG 文件，压缩后的数据会以多个 IDAT chunk 的形式输出
+class PngWriter {
+private:
+    static constexpr size_t IDAT_SIZE = 1 << 16;
+
+    std::ofstream fout;
+    std::string compressed;
+    DeflateEncoder deflater;
+    int width, height;
+    int rows_written = 0;
+
+    static void putU32(std::string& s, uint32_t v) {
+        for(int sh = 24; sh >= 0; sh -= 8) {
+            s.push_back((char)((v >> sh) & 0xFF));
+        }
+    }
+
+    void writeChunk(const char* type, const std::string& body) {
+        std::string chunk;
+        putU32(chunk, (uint32_t)body.size());
+        chunk.append(type, 4);
+        chunk += body;
+        uint32_t crc = Crc32::update(0, (const uint8_t*)chunk.data() + 4, chunk.size() - 4);
+        putU32(chunk, crc);
+        fout.write(chunk.data(), (std::streamsize)chunk.size());
+    }
+
+    void flushIdat(bool all) {
+        while(compressed.size() >= IDAT_SIZE || (all && !compressed.empty())) {
+            size_t len = std::min(compressed.size(), IDAT_SIZE);
+            writeChunk("IDAT", compressed.substr(0, len));
+            compressed.erase(0, len);
+        }
+    }
+
+public:
+    PngWriter(const std::string& filename, int _width, int _height):
+        fout(filename, std::ios::binary), deflater(compressed), width(_width), height(_height) {
+        if(!fout) {
+            throw std::runtime_error("could not open " + filename + " for writing");
+        }
+        ASSERT(width > 0 && height > 0);
+
+        static const unsigned char signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        fout.write((const char*)signature, sizeof(signature));
+
+        std::string ihdr;
+        putU32(ihdr, (uint32_t)width);
+        putU32(ihdr, (uint32_t)height);
+        ihdr.push_back((char)8); // 每个通道 8 位
+        ihdr.push_back((char)2); // RGB
+        ihdr.push_back((char)0); // deflate
+        ihdr.push_back((char)0); // 标准滤波
+        ihdr.push_back((char)0); // 不交错
+        writeChunk("IHDR", ihdr);
+    }
+
+    // 写入一行 RGB 像素，长度必须为 3 * width
+    void writeRow(const uint8_t* rgb) {
+        ASSERT(rows_written < height);
+        const uint8_t filter = 0;
+        deflater.write(&filter, 1);
+        deflater.write(rgb, (size_t)width * 3);
+        rows_written += 1;
+        flushIdat(false);
+    }
+
+    void finish() {
+        ASSERT(rows_written == height);
+        deflater.finish();
+        flushIdat(true);
+        writeChunk("IEND", "");
+        fout.flush();
+        if(!fout) {
+            throw std::runtime_error("failed to write PNG data");
+        }
+    }
+};
+
+// 将整张图片写入 PNG 文件
+inline void writePng(const RgbImage& image, const std::string& filename) {
+    PngWriter writer(filename, image.getWidth(), image.getHeight());
+    for(int y = 0; y < image.getHeight(); y += 1) {
+        writer.writeRow(image.rowData(y));
+    }
+    writer.finish();
+}
+
+// 逐行写入二进制 PPM (P6) 文件
+class PpmWriter {
+private:
+    std::ofstream fout;
+    int width, height;
+    int rows_written = 0;
+
+public:
+    PpmWriter(const std::string& filename, int _width, int _height):
+        fout(filename, std::ios::binary), width(_width), height(_height) {
+        if(!fout) {
+            throw std::runtime_error("could not open " + filename + " for writing");
+        }
+        fout << "P6\n" << width << " " << height << "\n255\n";
+    }
+
+    // 写入一行 RGB 像素，长度必须为 3 * width
+    void writeRow(const uint8_t* rgb) {
+        ASSERT(rows_written < height);
+        fout.write((const char*)rgb, (std::streamsize)width * 3);
+        rows_written += 1;
+    }
+
+    void finish() {
+        ASSERT(rows_written == height);
+        fout.flush();
+        if(!fout) {
+            throw std::runtime_error("failed to write PPM data");
+        }
+    }
+};
+
+// 将整张图片写入二进制 PPM (P6) 文件
+inline void writePpm(const RgbImage& image, const std::string& filename) {
+    PpmWriter writer(filename, image.getWidth(), image.getHeight());
+    for(int y = 0; y < image.getHeight(); y += 1) {
+        writer.writeRow(image.rowData(y));
+    }
+    writer.finish();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../Utils/MyAssert.h"
+
+// 一个最简单的 RGB 图像缓冲区，每个像素三个字节，按行连续存储
+class RgbImage {
+private:
+    int width, height;
+    std::vector<uint8_t> pixels;
+
+public:
+    RgbImage(int _width, int _height, uint8_t fill = 255):
+        width(_width), height(_height), pixels((size_t)_width * _height * 3, fill) {
+        ASSERT(width >= 0 && height >= 0);
+    }
+
+    int getWidth () const {return width ;}
+    int getHeight() const {return height;}
+
+    uint8_t* rowData(int y) {
+        return pixels.data() + (size_t)y * width * 3;
+    }
+    const uint8_t* rowData(int y) const {
+        return pixels.data() + (size_t)y * width * 3;
+    }
+
+    // 越界的像素会被直接忽略，方便绘制贴近边缘的文字
+    void setPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b) {
+        if(x < 0 || y < 0 || x >= width || y >= height) return;
+        uint8_t* p = rowData(y) + (size_t)x * 3;
+        p[0] = r;
+        p[1] = g;
+        p[2] = b;
+    }
+
+    // 把另一张图片整体复制到 (x0, y0) 位置
+    void paste(const RgbImage& src, int x0, int y0) {
+        int xl = std::max(0, x0);
+        int xr = std::min(width, x0 + src.getWidth());
+        if(xl >= xr) return;
+        for(int y = 0; y < src.getHeight(); y += 1) {
+            int ty = y0 + y;
+            if(ty < 0 || ty >= height) continue;
+            std::memcpy(
+                rowData(ty) + (size_t)xl * 3,
+                src.rowData(y) + (size_t)(xl - x0) * 3,
+                (size_t)(xr - xl) * 3);
+        }
+    }
+};
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../PathEngine/Common/LineData.h"
+#include "../Utils/Exceptions.h"
+#include "../Utils/MyAssert.h"
+
+// 把布线结果直接输出为 SVG 矢量图
+// 与 DiagramRenderer 不同，这里不经过二维布局矩阵，而是直接使用 LinkAlgo 中的线段
+// 因此输出大小只与线段数目有关，而与网格面积无关
+// 坐标系与 exportToIntMatrix 导出的矩阵一致：x 对应行（向下），y 对应列（向右）
+class SvgRenderer {
+public:
+    static constexpr int DEFAULT_TILE_SIZE = 30;
+
+private:
+    typedef std::tuple<int, int> Point;
+
+    int tile_size;
+    bool show_labels;
+    double line_width;
+
+    // 导出矩阵左上角对应的引擎坐标，以及矩阵的行列数
+    int x_origin, y_origin;
+    int rcnt, ccnt;
+
+    // 一条弧：从一个交叉点出发，沿若干拐点到达另一个交叉点
+    struct Arc {
+        int label;
+        std::vector<Point> points; // 去掉了共线点和重复点
+    };
+
+    static std::string formatNumber(double val) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.2f", val);
+        std::string ans = buf;
+        while(!ans.empty() && ans.back() == '0') ans.pop_back();
+        if(!ans.empty() && ans.back() == '.') ans.pop_back();
+        if(ans == "-0") ans = "0";
+        return ans;
+    }
+
+    // 引擎坐标转换为 SVG 坐标（格子中心）
+    double svgX(double y) const {return (y - y_origin + 0.5) * tile_size;}
+    double svgY(double x) const {return (x - x_origin + 0.5) * tile_size;}
+
+    static int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+
+    // 把同一个编号的所有线段首尾相接，串成一条折线
+    static std::vector<Arc> chainArcs(const std::vector<LineData>& edges, const std::set<Point>& crossing_pos) {
+        std::map<int, std::vector<LineData>> by_label;
+        for(const auto& ld: edges) {
+            if(ld.getXf() == ld.getXt() && ld.getYf() == ld.getYt()) continue; // 原地转向产生的零长度线段
+            by_label[ld.getV()].push_back(ld);
+        }
+
+        std::vector<Arc> arcs;
+        for(const auto& [label, segs]: by_label) {
+            if(label <= 0) {
+                THROW_EXCEPTION(BadDiagramException, "segment with non-positive label " + std::to_string(label));
+            }
+
+            std::map<Point, std::vector<int>> adj;
+            for(int i = 0; i < (int)segs.size(); i += 1) {
+                adj[Point(segs[i].getXf(), segs[i].getYf())].push_back(i);
+                adj[Point(segs[i].getXt(), segs[i].getYt())].push_back(i);
+            }
+
+            // 起点优先选择度数为一的端点，闭合的弧（两端在同一交叉点）则从交叉点出发
+            bool has_start = false;
+            Point start;
+            for(const auto& [pos, ids]: adj) {
+                if(ids.size() % 2 == 1) {
+                    start = pos;
+                    has_start = true;
+                    break;
+                }
+            }
+            if(!has_start) {
+                for(const auto& [pos, ids]: adj) {
+                    if(crossing_pos.count(pos)) {
+                        start = pos;
+                        has_start = true;
+                        break;
+                    }
+                }
+            }
+            if(!has_start) {
+                THROW_EXCEPTION(BadDiagramException, "arc " + std::to_string(label) + " does not touch any crossing");
+            }
+
+            Arc arc;
+            arc.label = label;
+            arc.points.push_back(start);
+            std::vector<bool> used(segs.size(), false);
+            Point cur = start;
+            for(int step = 0; step < (int)segs.size(); step += 1) {
+                int nxt_id = -1;
+                for(int id: adj[cur]) {
+                    if(!used[id]) {
+                        nxt_id = id;
+                        break;
+                    }
+                }
+                if(nxt_id == -1) break;
+                used[nxt_id] = true;
+
+                Point from(segs[nxt_id].getXf(), segs[nxt_id].getYf());
+                Point to  (segs[nxt_id].getXt(), segs[nxt_id].getYt());
+                Point nxt = (from == cur) ? to : from;
+
+                // 与上一段共线时直接延长
+                auto& pts = arc.points;
+                if(pts.size() >= 2) {
+                    auto [ax, ay] = pts[pts.size() - 2];
+                    auto [bx, by] = pts[pts.size() - 1];
+                    auto [cx, cy] = nxt;
+                    if(sign(bx - ax) == sign(cx - bx) && sign(by - ay) == sign(cy - by)) {
+                        pts.back() = nxt;
+                        cur = nxt;
+                        continue;
+                    }
+                }
+                pts.push_back(nxt);
+                cur = nxt;
+            }
+            if(std::find(used.begin(), used.end(), false) != used.end()) {
+                THROW_EXCEPTION(BadDiagramException, "segments of arc " + std::to_string(label) + " are not connected");
+            }
+            arcs.push_back(arc);
+        }
+        return arcs;
+    }
+
+    // 弧在端点 end 处离开交叉点的方向，(dx, dy) 为单位向量
+    static Point leaveDirection(const Point& end, const Point& next) {
+        return Point(sign(std::get<0>(next) - std::get<0>(end)), sign(std::get<1>(next) - std::get<1>(end)));
+    }
+
+    // 端点是否位于交叉点的下方线上，下方线的端点需要留出空隙
+    static bool isUnderAt(const std::map<Point, int>& crossing_val, const Point& end, const Point& dir) {
+        auto it = crossing_val.find(end);
+        if(it == crossing_val.end()) return false;
+        // -1: 沿 x 方向（矩阵中的竖直方向）的线在下方
+        // -2: 沿 y 方向（矩阵中的水平方向）的线在下方
+        if(it -> second == -1) return std::get<0>(dir) != 0;
+        return std::get<1>(dir) != 0;
+    }
+
+    std::string arcPath(const Arc& arc, const std::map<Point, int>& crossing_val) const {
+        const auto& pts = arc.points;
+        ASSERT(pts.size() >= 2);
+
+        // 转换到 SVG 坐标
+        std::vector<std::tuple<double, double>> sp;
+        for(const auto& [x, y]: pts) {
+            sp.emplace_back(svgX(y), svgY(x));
+        }
+
+        // 下方线的两端各自缩短 gap，与 DiagramRenderer 中挖去的圆盘半径一致
+        const double gap = 1.5 * line_width;
+        auto shorten = [&](int end_idx, int next_idx) {
+            auto dir = leaveDirection(pts[end_idx], pts[next_idx]);
+            if(!isUnderAt(crossing_val, pts[end_idx], dir)) return;
+            auto& [sx, sy] = sp[end_idx];
+            sx += std::get<1>(dir) * gap;
+            sy += std::get<0>(dir) * gap;
+        };
+        shorten(0, 1);
+        shorten((int)pts.size() - 1, (int)pts.size() - 2);
+
+        std::string d = "M" + formatNumber(std::get<0>(sp[0])) + " " + formatNumber(std::get<1>(sp[0]));
+        for(int i = 1; i + 1 < (int)sp.size(); i += 1) {
+            auto [ax, ay] = sp[i - 1];
+            auto [bx, by] = sp[i];
+            auto [cx, cy] = sp[i + 1];
+            double len1 = std::hypot(bx - ax, by - ay);
+            double len2 = std::hypot(cx - bx, cy - by);
+            double r = std::min({tile_size / 2.0, len1 / 2, len2 / 2});
+            double ux = (bx - ax) / len1, uy = (by - ay) / len1;
+            double vx = (cx - bx) / len2, vy = (cy - by) / len2;
+
+            // 拐角用半径为 r 的四分之一圆弧代替，顺时针转向时 sweep-flag 为 1
+            int sweep = (ux * vy - uy * vx) > 0 ? 1 : 0;
+            d += "L" + formatNumber(bx - ux * r) + " " + formatNumber(by - uy * r);
+            d += "A" + formatNumber(r) + " " + formatNumber(r) + " 0 0 " + std::to_string(sweep) + " "
+                + formatNumber(bx + vx * r) + " " + formatNumber(by + vy * r);
+        }
+        d += "L" + formatNumber(std::get<0>(sp.back())) + " " + formatNumber(std::get<1>(sp.back()));
+        return d;
+    }
+
+    // 在交叉点周围的四个格子上标出 socket 编号，位置规则与 DiagramRenderer 相同
+    void writeSocketLabels(std::ostream& out, const std::vector<Arc>& arcs, const std::map<Point, int>& crossing_val) const {
+        const int font_size = std::max(7, tile_size / 3);
+        const int margin = std::max(2, tile_size / 10);
+
+        out << "<g fill=\"rgb(220,0,0)\" font-family=\"sans-serif\" font-size=\"" << font_size << "\">\n";
+        for(const auto& arc: arcs) {
+            const auto& pts = arc.points;
+            for(int k = 0; k < 2; k += 1) {
+                int end_idx  = (k == 0) ? 0 : (int)pts.size() - 1;
+                int next_idx = (k == 0) ? 1 : (int)pts.size() - 2;
+                if(!crossing_val.count(pts[end_idx])) continue;
+
+                auto [dx, dy] = leaveDirection(pts[end_idx], pts[next_idx]);
+                int ni = std::get<0>(pts[end_idx]) + dx - x_origin;
+                int nj = std::get<1>(pts[end_idx]) + dy - y_origin;
+
+                // 上方和左侧的邻居把编号写在右下角，右侧和下方的邻居写在左上角
+                bool right_down = (dx == -1 || dy == -1);
+                if(right_down) {
+                    out << "<text x=\"" << (nj + 1) * tile_size - margin
+                        << "\" y=\"" << (ni + 1) * tile_size - margin
+                        << "\" text-anchor=\"end\">" << arc.label << "</text>\n";
+                }else {
+                    out << "<text x=\"" << nj * tile_size + margin
+                        << "\" y=\"" << ni * tile_size + margin
+                        << "\" dominant-baseline=\"hanging\">" << arc.label << "</text>\n";
+                }
+            }
+        }
+        out << "</g>\n";
+    }
+
+public:
+    SvgRenderer(int _tile_size = DEFAULT_TILE_SIZE, bool _show_labels = false):
+        tile_size(_tile_size), show_labels(_show_labels),
+        x_origin(0), y_origin(0), rcnt(0), ccnt(0) {
+        if(tile_size <= 0) {
+            throw std::invalid_argument("tile size must be positive");
+        }
+        line_width = std::max(1.0, std::round(tile_size * 4.0 / DEFAULT_TILE_SIZE));
+    }
+
+    // edges 是所有弧的线段，crossings 是所有交叉点（零长度线段，值为 -1 或 -2）
+    void render(std::ostream& out, const std::vector<LineData>& edges, const std::vector<LineData>& crossings) {
+        std::map<Point, int> crossing_val;
+        std::set<Point> crossing_pos;
+        for(const auto& ld: crossings) {
+            if(ld.getV() != -1 && ld.getV() != -2) {
+                THROW_EXCEPTION(BadDiagramException, "unsupported crossing value " + std::to_string(ld.getV()));
+            }
+            crossing_val[Point(ld.getXf(), ld.getYf())] = ld.getV();
+            crossing_pos.insert(Point(ld.getXf(), ld.getYf()));
+        }
+
+        // 与 exportToIntMatrix 相同，四周各留出一格空白
+        int xmin = 0, xmax = -1, ymin = 0, ymax = -1;
+        bool first = true;
+        auto extend = [&](int x, int y) {
+            if(first) {
+                xmin = xmax = x;
+                ymin = ymax = y;
+                first = false;
+            }
+            xmin = std::min(xmin, x); xmax = std::max(xmax, x);
+            ymin = std::min(ymin, y); ymax = std::max(ymax, y);
+        };
+        for(const auto& ld: edges) {
+            extend(ld.getXf(), ld.getYf());
+            extend(ld.getXt(), ld.getYt());
+        }
+        for(const auto& [pos, val]: crossing_val) {
+            extend(std::get<0>(pos), std::get<1>(pos));
+        }
+        x_origin = xmin - 1;
+        y_origin = ymin - 1;
+        rcnt = xmax - xmin + 3;
+        ccnt = ymax - ymin + 3;
+
+        auto arcs = chainArcs(edges, crossing_pos);
+
+        int width  = ccnt * tile_size;
+        int height = rcnt * tile_size;
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+            << "\" viewBox=\"0 0 " << width << " " << height << "\">\n";
+        out << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+        out << "<g fill=\"none\" stroke=\"black\" stroke-width=\"" << formatNumber(line_width)
+            << "\" stroke-linejoin=\"round\">\n";
+        for(const auto& arc: arcs) {
+            if(arc.points.size() < 2) continue;
+            out << "<path data-arc=\"" << arc.label << "\" d=\"" << arcPath(arc, crossing_val) << "\"/>\n";
+        }
+        out << "</g>\n";
+        if(show_labels) {
+            writeSocketLabels(out, arcs, crossing_val);
+        }
+        out << "</svg>\n";
+    }
+};
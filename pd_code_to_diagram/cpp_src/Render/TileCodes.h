@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "DiagramRenderer.h"
+#include "../LinkAlgo.h"
+#include "../Utils/Exceptions.h"
+#include "../Utils/GridBuffer.h"
+
+// 直接由布线得到的线段计算每个格子使用的贴图，不需要在矩阵上查看邻居
+// 格子坐标与 exportToIntMatrix 导出的矩阵一致，贴图编号与 DiagramRenderer::tileCodeForCell 一致
+// 输出时每个格子用一个字符表示：
+//   '0' 空白，'3' '5' '6' '9' 'a' 'c' 是十六进制的线段 mask，'h' 是 -1（横线在上），'v' 是 -2（竖线在上）
+class TileCodes {
+private:
+    GridBuffer<int8_t> codes;
+
+    // 引擎坐标中 x 对应行，y 对应列
+    static int maskByDelta(int dx, int dy) {
+        if(dx == -1) return DiagramRenderer::MASK_TOP;
+        if(dy ==  1) return DiagramRenderer::MASK_RIGHT;
+        if(dx ==  1) return DiagramRenderer::MASK_BOTTOM;
+        return DiagramRenderer::MASK_LEFT;
+    }
+
+    static int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+
+public:
+    explicit TileCodes(LinkAlgo& link_algo): codes(0, 0) {
+        int xmin, xmax, ymin, ymax;
+        std::tie(xmin, xmax, ymin, ymax) = link_algo.getFinalGraph().getBorderCoord();
+        const int x0 = xmin - 1;
+        const int y0 = ymin - 1;
+        codes = GridBuffer<int8_t>(xmax - xmin + 3, ymax - ymin + 3, 0);
+
+        // 线段从格子中心连到格子中心，每一步在相邻的两个格子上各记一个方向
+        for(const auto& ld: link_algo.getAllEdges()) {
+            int dx = sign(ld.getXt() - ld.getXf());
+            int dy = sign(ld.getYt() - ld.getYf());
+            if(dx == 0 && dy == 0) continue;
+
+            int x = ld.getXf(), y = ld.getYf();
+            while(x != ld.getXt() || y != ld.getYt()) {
+                codes.at(x - x0, y - y0) |= maskByDelta(dx, dy);
+                x += dx;
+                y += dy;
+                codes.at(x - x0, y - y0) |= maskByDelta(-dx, -dy);
+            }
+        }
+
+        // 线段在交叉点处留下的方向不需要保留，交叉点直接使用 -1 或者 -2
+        for(const auto& ld: link_algo.getAllCrossings()) {
+            codes.at(ld.getXf() - x0, ld.getYf() - y0) = (int8_t)ld.getV();
+        }
+
+        for(int i = 0; i < codes.getRcnt(); i += 1) {
+            for(int j = 0; j < codes.getCcnt(); j += 1) {
+                int code = codes.at(i, j);
+                if(code > 0 && !DiagramRenderer::isLineMask(code)) {
+                    THROW_EXCEPTION(BadDiagramException, "segments at (" + std::to_string(i) + ", "
+                        + std::to_string(j) + ") need unsupported tile " + std::to_string(code));
+                }
+            }
+        }
+    }
+
+    // 输入本身就是二维布局矩阵时，只能通过查看邻居得到贴图编号
+    explicit TileCodes(const AbstractIntMatrix2& aim): codes(aim.getRcnt(), aim.getCcnt(), 0) {
+        for(int i = 0; i < aim.getRcnt(); i += 1) {
+            for(int j = 0; j < aim.getCcnt(); j += 1) {
+                codes.at(i, j) = (int8_t)DiagramRenderer::tileCodeForCell(aim, i, j);
+            }
+        }
+    }
+
+    int getRcnt() const {return codes.getRcnt();}
+    int getCcnt() const {return codes.getCcnt();}
+
+    int getCode(int i, int j) const {
+        return codes.at(i, j);
+    }
+
+    static char encode(int code) {
+        if(code == -1) return 'h';
+        if(code == -2) return 'v';
+        return "0123456789abcdef"[code];
+    }
+
+    // 输出为单行 JSON：{"tiles": ["每一行的字符", ...]}
+    std::string jsonify() const {
+        std::stringstream ss;
+        ss << "{\"tiles\": [";
+        for(int i = 0; i < codes.getRcnt(); i += 1) {
+            if(i != 0) ss << ", ";
+            ss << "\"";
+            for(int j = 0; j < codes.getCcnt(); j += 1) {
+                ss << encode(codes.at(i, j));
+            }
+            ss << "\"";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+};
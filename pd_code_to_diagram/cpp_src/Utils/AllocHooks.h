@@ -0,0 +1,100 @@
+#pragma once
+
+// 替换全局 operator new / operator delete，把每次分配计入 AllocStats
+// 只能被可执行程序的入口文件（main.cpp, Bench/bench.cpp）引入一次
+// 编译为动态库（-DNO_MAIN）时不做替换，以免影响宿主进程；在编译时引入 -DNO_ALLOC_STATS 同样不做替换
+//
+// 块的大小由分配器给出（malloc_usable_size 等），所以释放时不需要知道分配时的大小，也不需要额外的头部
+// 对齐分配（align_val_t 版本）保持默认实现，不计入统计
+
+#include <cstdlib>
+#include <new>
+
+#include "AllocStats.h"
+
+#if !defined(NO_MAIN) && !defined(NO_ALLOC_STATS)
+    #if defined(__GLIBC__)
+        #include <malloc.h>
+        #define ALLOC_HOOKS_BLOCK_SIZE(PTR) malloc_usable_size(PTR)
+    #elif defined(__APPLE__)
+        #include <malloc/malloc.h>
+        #define ALLOC_HOOKS_BLOCK_SIZE(PTR) malloc_size(PTR)
+    #elif defined(_WIN32)
+        #include <malloc.h>
+        #define ALLOC_HOOKS_BLOCK_SIZE(PTR) _msize(PTR)
+    #endif
+#endif
+
+#ifdef ALLOC_HOOKS_BLOCK_SIZE
+
+inline void* allocHooksNew(std::size_t size) noexcept {
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if(ptr != nullptr) {
+        AllocStats::onAlloc(ALLOC_HOOKS_BLOCK_SIZE(ptr));
+    }
+    return ptr;
+}
+
+inline void allocHooksDelete(void* ptr) noexcept {
+    if(ptr != nullptr) {
+        AllocStats::onFree(ALLOC_HOOKS_BLOCK_SIZE(ptr));
+        std::free(ptr);
+    }
+}
+
+// 分配失败时与默认实现一样调用 new_handler，没有 new_handler 时抛出 std::bad_alloc
+inline void* allocHooksNewOrThrow(std::size_t size) {
+    while(true) {
+        void* ptr = allocHooksNew(size);
+        if(ptr != nullptr) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if(handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size) {
+    return allocHooksNewOrThrow(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocHooksNewOrThrow(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocHooksNew(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocHooksNew(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    allocHooksDelete(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    allocHooksDelete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    allocHooksDelete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    allocHooksDelete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    allocHooksDelete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    allocHooksDelete(ptr);
+}
+
+#endif
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+// 按子系统统计堆内存的分配
+// 计数由 AllocHooks.h 中替换的全局 operator new / operator delete 完成，只有可执行程序会引入这些替换
+// 没有引入替换（例如编译为动态库，或者在编译时引入 -DNO_ALLOC_STATS）时所有数字都是 0
+// 引擎是单线程的，计数没有做同步
+enum class AllocTag {
+    OTHER,      // 不在任何标记范围内的分配（读入 pd_code 等）
+    TREE,       // 生成树形图与 socket 信息
+    ROUTING,    // 最短路布线
+    COMPACTION, // 布线前后的坐标稀疏化与稠密化
+    BORDER,     // 外侧连通分支检查
+    OUTPUT,     // 导出矩阵、三维节点集合以及各种输出
+    TAG_CNT
+};
+
+struct AllocTagStats {
+    uint64_t bytes = 0;           // 累计分配的字节数
+    uint64_t allocations = 0;     // 累计分配次数
+    int64_t  peak_live_bytes = 0; // 在这个范围内观察到的最大存活字节数（全局）
+};
+
+class AllocStats {
+private:
+    inline static AllocTag current = AllocTag::OTHER;
+    inline static int64_t live_bytes = 0;
+    inline static int64_t peak_live_bytes = 0;
+    inline static AllocTagStats tags[(int)AllocTag::TAG_CNT] = {};
+
+public:
+    static const char* getName(AllocTag tag) {
+        static const char* names[] = {"other", "tree", "routing", "compaction", "border", "output"};
+        static_assert(sizeof(names) / sizeof(names[0]) == (int)AllocTag::TAG_CNT, "missing tag name");
+        return names[(int)tag];
+    }
+
+    static AllocTag getCurrent() {
+        return current;
+    }
+
+    static void setCurrent(AllocTag tag) {
+        current = tag;
+    }
+
+    // 由 operator new / operator delete 调用，bytes 是分配器实际给出的块大小
+    static void onAlloc(size_t bytes) {
+        auto& tag = tags[(int)current];
+        tag.bytes += bytes;
+        tag.allocations += 1;
+        live_bytes += (int64_t)bytes;
+        peak_live_bytes = std::max(peak_live_bytes, live_bytes);
+        tag.peak_live_bytes = std::max(tag.peak_live_bytes, live_bytes);
+    }
+
+    static void onFree(size_t bytes) {
+        live_bytes -= (int64_t)bytes;
+    }
+
+    static int64_t getLiveBytes() {
+        return live_bytes;
+    }
+
+    static int64_t getPeakLiveBytes() {
+        return peak_live_bytes;
+    }
+
+    static const AllocTagStats& getTagStats(AllocTag tag) {
+        return tags[(int)tag];
+    }
+
+    // 把峰值重置为当前的存活字节数，并清空累计数字
+    static void reset() {
+        peak_live_bytes = live_bytes;
+        for(auto& tag: tags) {
+            tag = AllocTagStats();
+        }
+    }
+
+    // {"live_bytes": ..., "peak_live_bytes": ..., "total_bytes": ..., "allocations": ..., "by_scope": {...}}
+    // 先复制一份快照，拼接字符串本身也会分配内存
+    static std::string jsonify() {
+        AllocTagStats snapshot[(int)AllocTag::TAG_CNT];
+        std::copy(std::begin(tags), std::end(tags), std::begin(snapshot));
+        int64_t live_now = live_bytes, peak_now = peak_live_bytes;
+
+        uint64_t total_bytes = 0, allocations = 0;
+        std::stringstream by_scope;
+        for(int i = 0; i < (int)AllocTag::TAG_CNT; i += 1) {
+            const auto& tag = snapshot[i];
+            total_bytes += tag.bytes;
+            allocations += tag.allocations;
+            by_scope << (i == 0 ? "" : ", ") << "\"" << getName((AllocTag)i) << "\": {"
+                     << "\"bytes\": " << tag.bytes
+                     << ", \"allocations\": " << tag.allocations
+                     << ", \"peak_live_bytes\": " << tag.peak_live_bytes << "}";
+        }
+        std::stringstream ss;
+        ss << "{\"live_bytes\": " << live_now
+           << ", \"peak_live_bytes\": " << peak_now
+           << ", \"total_bytes\": " << total_bytes
+           << ", \"allocations\": " << allocations
+           << ", \"by_scope\": {" << by_scope.str() << "}}";
+        return ss.str();
+    }
+};
+
+// 在作用域内的分配都记到 TAG 上，离开作用域时恢复外层的标记
+class ScopedAllocTag {
+private:
+    AllocTag previous;
+
+public:
+    explicit ScopedAllocTag(AllocTag tag): previous(AllocStats::getCurrent()) {
+        AllocStats::setCurrent(tag);
+    }
+
+    ~ScopedAllocTag() {
+        AllocStats::setCurrent(previous);
+    }
+
+    ScopedAllocTag(const ScopedAllocTag&) = delete;
+    ScopedAllocTag& operator=(const ScopedAllocTag&) = delete;
+};
+
+#define ALLOC_SCOPE_CONCAT_INNER(A, B) A##B
+#define ALLOC_SCOPE_CONCAT(A, B) ALLOC_SCOPE_CONCAT_INNER(A, B)
+
+#ifdef NO_ALLOC_STATS
+    #define ALLOC_SCOPE(TAG)
+#else
+    // 从当前位置到所在作用域结束的分配都记到 AllocTag::TAG 上
+    #define ALLOC_SCOPE(TAG) \
+        ScopedAllocTag ALLOC_SCOPE_CONCAT(scoped_alloc_tag_, __LINE__)(AllocTag::TAG)
+#endif
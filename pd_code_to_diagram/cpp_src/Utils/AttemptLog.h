@@ -0,0 +1,92 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 每个随机种子的尝试结果
+enum class AttemptOutcome {
+    SUCCESS,        // 布局成功
+    TREE_OVERLAP,   // 树形图多次生成后仍然有交叉点重叠
+    BAD_BORDER,     // 指定的连通分支没有位于最外侧
+    ROUTING_ASSERT, // 布线过程中断言失败，这个异常不会重试，会直接抛给调用者
+    TIMEOUT,        // 超过了时间预算，同样直接抛给调用者
+    OUTCOME_CNT
+};
+
+struct AttemptRecord {
+    unsigned int seed   = 0;
+    int last_socket_id  = -1;
+    AttemptOutcome outcome = AttemptOutcome::SUCCESS;
+    int tree_attempts   = 0;  // 生成树形图的次数
+    double ms           = 0;  // 这个种子花费的时间（毫秒）
+    int rows            = 0;  // 达到的网格大小，没有完成布线时为 0
+    int cols            = 0;
+};
+
+// 记录 PdToDiagram2d::convert 中每个随机种子的结果
+// 每个种子只记录一次，开销相对于一次布局可以忽略，所以总是开启
+class AttemptLog {
+private:
+    inline static std::vector<AttemptRecord> records;
+
+public:
+    static const char* getName(AttemptOutcome outcome) {
+        static const char* names[] = {"success", "tree_overlap", "bad_border", "routing_assert", "timeout"};
+        static_assert(sizeof(names) / sizeof(names[0]) == (int)AttemptOutcome::OUTCOME_CNT, "missing outcome name");
+        return names[(int)outcome];
+    }
+
+    static void add(const AttemptRecord& record) {
+        records.push_back(record);
+    }
+
+    static const std::vector<AttemptRecord>& getRecords() {
+        return records;
+    }
+
+    static void clear() {
+        records.clear();
+    }
+
+    // 单个种子：{"attempt": {"seed": ..., "outcome": ..., ...}}
+    static std::string jsonify(const AttemptRecord& record) {
+        std::stringstream ss;
+        ss << "{\"attempt\": {\"seed\": " << record.seed
+           << ", \"last_socket_id\": " << record.last_socket_id
+           << ", \"outcome\": \"" << getName(record.outcome) << "\""
+           << ", \"tree_attempts\": " << record.tree_attempts
+           << ", \"ms\": " << record.ms
+           << ", \"rows\": " << record.rows
+           << ", \"cols\": " << record.cols << "}}";
+        return ss.str();
+    }
+
+    // 按结果汇总：{"success": {"count": ..., "ms": ...}, ...}
+    static std::string jsonifyHistogram() {
+        int count[(int)AttemptOutcome::OUTCOME_CNT] = {};
+        double ms[(int)AttemptOutcome::OUTCOME_CNT] = {};
+        for(const auto& record: records) {
+            count[(int)record.outcome] += 1;
+            ms[(int)record.outcome] += record.ms;
+        }
+        std::stringstream ss;
+        ss << "{";
+        for(int i = 0; i < (int)AttemptOutcome::OUTCOME_CNT; i += 1) {
+            if(i != 0) ss << ", ";
+            ss << "\"" << getName((AttemptOutcome)i) << "\": {\"count\": " << count[i] << ", \"ms\": " << ms[i] << "}";
+        }
+        ss << "}";
+        return ss.str();
+    }
+
+    // 每个种子一行 JSON，行之间用换行分隔，最后一行没有换行
+    static std::string jsonifyLines() {
+        std::string ans;
+        for(const auto& record: records) {
+            if(!ans.empty()) ans += "\n";
+            ans += jsonify(record);
+        }
+        return ans;
+    }
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MyAssert.h"
+
+// 按位压缩存储的二维 0/1 矩阵，每个格子只占一个比特
+// 格子按行优先编号，既可以用 (i, j) 访问，也可以直接用编号访问
+// 与 GridBuffer 一样只能移动，需要副本时使用 clone
+class BitGrid {
+private:
+    std::vector<uint64_t> words;
+    int rcnt, ccnt;
+
+    static std::size_t wordCount(std::size_t bits) {
+        return (bits + 63) / 64;
+    }
+
+public:
+    BitGrid(int r, int c): words(wordCount((std::size_t)r * c), 0), rcnt(r), ccnt(c) {
+        ASSERT(r >= 0 && c >= 0);
+    }
+
+    BitGrid(BitGrid&& rhs) noexcept:
+        words(std::move(rhs.words)), rcnt(rhs.rcnt), ccnt(rhs.ccnt) {
+        rhs.rcnt = rhs.ccnt = 0;
+    }
+
+    BitGrid& operator=(BitGrid&& rhs) noexcept {
+        words = std::move(rhs.words);
+        rcnt  = rhs.rcnt;
+        ccnt  = rhs.ccnt;
+        rhs.rcnt = rhs.ccnt = 0;
+        return *this;
+    }
+
+    BitGrid(const BitGrid&) = delete;
+    BitGrid& operator=(const BitGrid&) = delete;
+
+    BitGrid clone() const {
+        BitGrid ans(rcnt, ccnt);
+        ans.words = words;
+        return ans;
+    }
+
+    int getRcnt() const {return rcnt;}
+    int getCcnt() const {return ccnt;}
+    std::size_t size() const {return (std::size_t)rcnt * ccnt;}
+
+    std::size_t index(int i, int j) const {
+        ASSERT(0 <= i && i < rcnt && 0 <= j && j < ccnt);
+        return (std::size_t)i * ccnt + j;
+    }
+
+    bool testIndex(std::size_t idx) const {
+        return (words[idx >> 6] >> (idx & 63)) & 1;
+    }
+
+    void setIndex(std::size_t idx) {
+        words[idx >> 6] |= (uint64_t)1 << (idx & 63);
+    }
+
+    bool get(int i, int j) const {
+        return testIndex(index(i, j));
+    }
+
+    void set(int i, int j, bool v) {
+        std::size_t idx = index(i, j);
+        uint64_t mask = (uint64_t)1 << (idx & 63);
+        if(v) {
+            words[idx >> 6] |= mask;
+        }else {
+            words[idx >> 6] &= ~mask;
+        }
+    }
+
+    // 所有位置取反，最后一个字中超出矩阵范围的比特保持为零
+    void flipAll() {
+        for(auto& word: words) {
+            word = ~word;
+        }
+        std::size_t tail = size() & 63;
+        if(tail != 0) {
+            words.back() &= ((uint64_t)1 << tail) - 1;
+        }
+    }
+
+    // 按编号从小到大对每一个值为 1 的位置调用 func(idx)，整字为零时直接跳过
+    template<typename Func>
+    void forEachSet(Func&& func) const {
+        for(std::size_t w = 0; w < words.size(); w += 1) {
+            uint64_t word = words[w];
+            while(word != 0) {
+                func((w << 6) + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // 统计值为 1 的位置个数
+    std::size_t count() const {
+        std::size_t ans = 0;
+        for(auto word: words) {
+            ans += __builtin_popcountll(word);
+        }
+        return ans;
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#include "GridBuffer.h"
+#include "MyAssert.h"
+
+// 矩阵格子使用的整数宽度
+// 格子中的值只有弧的编号（不超过 2n）以及交叉点标记 -1, -2
+// 因此绝大多数布局图都可以用 16 位整数存储，内存带宽减半
+enum class CellWidth {
+    NARROW, // int16_t
+    WIDE    // int
+};
+
+// 运行时选择格子宽度的连续二维矩阵
+// 两种宽度各有一个缓冲区，未使用的那个大小为零
+class CellGrid {
+private:
+    CellWidth width;
+    GridBuffer<int16_t> narrow;
+    GridBuffer<int> wide;
+
+public:
+    // 根据值域选择格子宽度
+    static CellWidth chooseWidth(int min_val, int max_val) {
+        if(std::numeric_limits<int16_t>::min() <= min_val && max_val <= std::numeric_limits<int16_t>::max()) {
+            return CellWidth::NARROW;
+        }
+        return CellWidth::WIDE;
+    }
+
+    CellGrid(int r, int c, CellWidth _width):
+        width(_width),
+        narrow(_width == CellWidth::NARROW ? r : 0, _width == CellWidth::NARROW ? c : 0, 0),
+        wide  (_width == CellWidth::WIDE   ? r : 0, _width == CellWidth::WIDE   ? c : 0, 0) {
+    }
+
+    CellGrid(CellGrid&&) = default;
+    CellGrid& operator=(CellGrid&&) = default;
+
+    CellGrid clone() const {
+        CellGrid ans(0, 0, width);
+        ans.narrow = narrow.clone();
+        ans.wide   = wide.clone();
+        return ans;
+    }
+
+    CellWidth getWidth() const {return width;}
+    int getRcnt() const {return width == CellWidth::NARROW ? narrow.getRcnt() : wide.getRcnt();}
+    int getCcnt() const {return width == CellWidth::NARROW ? narrow.getCcnt() : wide.getCcnt();}
+
+    int get(int i, int j) const {
+        return width == CellWidth::NARROW ? narrow.at(i, j) : wide.at(i, j);
+    }
+
+    void set(int i, int j, int v) {
+        if(width == CellWidth::NARROW) {
+            ASSERT(chooseWidth(v, v) == CellWidth::NARROW);
+            narrow.at(i, j) = (int16_t)v;
+        }else {
+            wide.at(i, j) = v;
+        }
+    }
+
+    // 以实际的格子类型调用 func(GridView<const Cell>)，供需要逐格扫描的算法使用
+    template<typename Func>
+    decltype(auto) visit(Func&& func) const {
+        if(width == CellWidth::NARROW) {
+            return func(narrow.view());
+        }
+        return func(wide.view());
+    }
+};
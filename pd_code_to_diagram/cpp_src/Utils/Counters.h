@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// 热点路径上的事件计数器
+// 每个线程拥有自己的一组计数槽，每个槽独占一条 64 字节的缓存行，计数时不需要任何同步
+// 引擎是单线程的，--stats 输出的是主线程的计数
+// 在编译时引入 -DNO_COUNTERS 可以把所有 COUNTER_ADD 完全去掉
+enum class Counter {
+    SPFA_POP,             // SPFA 出队次数
+    SPFA_RELAX,           // 距离被更新的次数
+    SPFA_REENQUEUE,       // 已经出过队的状态再次入队的次数
+    GETPOS_PIXEL,         // 各个地图类的 getPos 调用次数
+    GETPOS_VECTOR,
+    GETPOS_MERGE,
+    GETPOS_SPAN,
+    GETPOS_ERASE_POINT,
+    GETPOS_MARGIN,
+    COMMIT_COORD_MAP,     // LinkAlgo 坐标映射的次数，每次同时映射两层地图与 SocketInfo
+    COMMIT_CELLS,         // commitCoordMap 重写的格子数
+    PDTREE_RESTART,       // 树形图因为交叉点重叠而重新生成的次数
+    SEEDS_TRIED,          // 尝试过的随机种子个数
+    EXC_CROSSING_MEET,    // 各类异常的抛出次数，在抛出处计数
+    EXC_BAD_BORDER,
+    EXC_MAX_TRY,
+    EXC_TIME_BUDGET,
+    COUNTER_CNT
+};
+
+class Counters {
+private:
+    struct alignas(64) Slot {
+        uint64_t value;
+    };
+
+    inline static thread_local Slot slots[(int)Counter::COUNTER_CNT] = {};
+
+public:
+    static const char* getName(Counter c) {
+        static const char* names[] = {
+            "spfa_pop", "spfa_relax", "spfa_reenqueue",
+            "getpos_pixel", "getpos_vector", "getpos_merge",
+            "getpos_span", "getpos_erase_point", "getpos_margin",
+            "commit_coord_map", "commit_cells",
+            "pdtree_restart", "seeds_tried",
+            "exc_crossing_meet", "exc_bad_border", "exc_max_try", "exc_time_budget",
+        };
+        static_assert(sizeof(names) / sizeof(names[0]) == (int)Counter::COUNTER_CNT, "missing counter name");
+        return names[(int)c];
+    }
+
+    static void add(Counter c, uint64_t v = 1) {
+        slots[(int)c].value += v;
+    }
+
+    static uint64_t get(Counter c) {
+        return slots[(int)c].value;
+    }
+
+    static void reset() {
+        for(auto& slot: slots) {
+            slot.value = 0;
+        }
+    }
+
+    // 作用域结束时恢复进入时的计数，用于不应计入统计的诊断代码
+    class Pause {
+    private:
+        uint64_t saved[(int)Counter::COUNTER_CNT];
+
+    public:
+        Pause() {
+            for(int i = 0; i < (int)Counter::COUNTER_CNT; i += 1) saved[i] = slots[i].value;
+        }
+        ~Pause() {
+            for(int i = 0; i < (int)Counter::COUNTER_CNT; i += 1) slots[i].value = saved[i];
+        }
+        Pause(const Pause&) = delete;
+        Pause& operator=(const Pause&) = delete;
+    };
+
+    // 所有计数：{"spfa_pop": ..., ...}
+    static std::string jsonifyCounts() {
+        std::stringstream ss;
+        ss << "{";
+        for(int i = 0; i < (int)Counter::COUNTER_CNT; i += 1) {
+            if(i != 0) ss << ", ";
+            ss << "\"" << getName((Counter)i) << "\": " << slots[i].value;
+        }
+        ss << "}";
+        return ss.str();
+    }
+
+    // 输出为单行 JSON：{"stats": {"spfa_pop": ..., ...}}
+    static std::string jsonify() {
+        return "{\"stats\": " + jsonifyCounts() + "}";
+    }
+};
+
+#ifdef NO_COUNTERS
+    #define COUNTER_ADD(NAME, VALUE)
+#else
+    #define COUNTER_ADD(NAME, VALUE) Counters::add(Counter::NAME, (uint64_t)(VALUE))
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+// 诊断功能（Profiler、TimeBudget、SearchHeatmap、GraphWorkloadRecorder）共用的全局开关
+// 以 CRTP 的方式继承，每个功能各自有一个静态的开关，默认关闭
+// 开关几乎总是关闭的，因此 isEnabled 提示编译器按不成立预测：没有启用时每个检查点只多一次预测为不成立的分支
+template<typename Feature>
+class EnableFlag {
+private:
+    inline static bool enabled = false;
+
+protected:
+    static void setEnabled(bool value) {
+        enabled = value;
+    }
+
+public:
+    static bool isEnabled() {
+        return __builtin_expect(enabled, 0);
+    }
+};
@@ -37,3 +37,9 @@ DEFINE_EXCEPTION(CrossingMeetException);
 
 // 超过了最大尝试次数
 DEFINE_EXCEPTION(MaxTryExceeded);
+
+// 超过了 TimeBudget 给出的时间预算
+DEFINE_EXCEPTION(TimeBudgetExceeded);
+
+// 输入的二维布局矩阵不合法或者无法解析
+DEFINE_EXCEPTION(BadDiagramException);
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "MyAssert.h"
+
+// 不拥有内存的二维视图，按行优先访问
+// stride 是相邻两行起始地址之间相差的元素个数，因此可以表示一个更大矩阵中的子矩形
+// 同一行中的元素总是连续存储，按行扫描时对缓存友好，也便于编译器自动向量化
+template<typename T>
+class GridView {
+private:
+    T* base;
+    int rcnt, ccnt;
+    std::ptrdiff_t stride;
+
+public:
+    GridView(T* _base, int _rcnt, int _ccnt, std::ptrdiff_t _stride):
+        base(_base), rcnt(_rcnt), ccnt(_ccnt), stride(_stride) {
+        ASSERT(rcnt >= 0 && ccnt >= 0 && stride >= ccnt);
+    }
+
+    // 可写视图可以隐式转换为只读视图
+    template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    GridView(const GridView<U>& rhs): base(rhs.base), rcnt(rhs.rcnt), ccnt(rhs.ccnt), stride(rhs.stride) {}
+
+    template<typename> friend class GridView;
+
+    int getRcnt() const {return rcnt;}
+    int getCcnt() const {return ccnt;}
+    std::ptrdiff_t getStride() const {return stride;}
+
+    // 获取一行数据的起始地址
+    T* row(int i) const {
+        ASSERT(0 <= i && i < rcnt);
+        return base + i * stride;
+    }
+
+    T& at(int i, int j) const {
+        ASSERT(0 <= i && i < rcnt && 0 <= j && j < ccnt);
+        return base[i * stride + j];
+    }
+
+    // 以 (r0, c0) 为左上角、大小为 r * c 的子矩形，与原视图共享内存
+    GridView subView(int r0, int c0, int r, int c) const {
+        ASSERT(0 <= r0 && 0 <= r && r0 + r <= rcnt);
+        ASSERT(0 <= c0 && 0 <= c && c0 + c <= ccnt);
+        return GridView(base + r0 * stride + c0, r, c, stride);
+    }
+};
+
+// 连续存储的二维矩阵，所有元素放在同一块内存中，行与行首尾相接
+// 只能移动不能拷贝，避免大矩阵在函数之间传递时被隐式复制；确实需要副本时使用 clone
+template<typename T>
+class GridBuffer {
+private:
+    std::vector<T> cells;
+    int rcnt, ccnt;
+
+public:
+    GridBuffer(int r, int c, T fill = T()): cells((std::size_t)r * c, fill), rcnt(r), ccnt(c) {
+        ASSERT(r >= 0 && c >= 0);
+    }
+
+    GridBuffer(GridBuffer&& rhs) noexcept:
+        cells(std::move(rhs.cells)), rcnt(rhs.rcnt), ccnt(rhs.ccnt) {
+        rhs.rcnt = rhs.ccnt = 0;
+    }
+
+    GridBuffer& operator=(GridBuffer&& rhs) noexcept {
+        cells = std::move(rhs.cells);
+        rcnt  = rhs.rcnt;
+        ccnt  = rhs.ccnt;
+        rhs.rcnt = rhs.ccnt = 0;
+        return *this;
+    }
+
+    GridBuffer(const GridBuffer&) = delete;
+    GridBuffer& operator=(const GridBuffer&) = delete;
+
+    // 显式拷贝
+    GridBuffer clone() const {
+        GridBuffer ans(rcnt, ccnt);
+        ans.cells = cells;
+        return ans;
+    }
+
+    int getRcnt() const {return rcnt;}
+    int getCcnt() const {return ccnt;}
+
+    T* data() {return cells.data();}
+    const T* data() const {return cells.data();}
+    std::size_t size() const {return cells.size();}
+
+    T* row(int i) {
+        ASSERT(0 <= i && i < rcnt);
+        return cells.data() + (std::size_t)i * ccnt;
+    }
+    const T* row(int i) const {
+        ASSERT(0 <= i && i < rcnt);
+        return cells.data() + (std::size_t)i * ccnt;
+    }
+
+    T& at(int i, int j) {
+        ASSERT(0 <= i && i < rcnt && 0 <= j && j < ccnt);
+        return cells[(std::size_t)i * ccnt + j];
+    }
+    const T& at(int i, int j) const {
+        ASSERT(0 <= i && i < rcnt && 0 <= j && j < ccnt);
+        return cells[(std::size_t)i * ccnt + j];
+    }
+
+    GridView<T> view() {
+        return GridView<T>(cells.data(), rcnt, ccnt, ccnt);
+    }
+    GridView<const T> view() const {
+        return GridView<const T>(cells.data(), rcnt, ccnt, ccnt);
+    }
+};
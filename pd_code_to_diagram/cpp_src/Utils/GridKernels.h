@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+
+#include "GridBuffer.h"
+#include "MyAssert.h"
+
+// 逐行扫描 GridView 的基础算法
+// 每一行内部是连续内存，归约时使用 8 路独立的累加器，方便编译器把内层循环向量化
+// GCC 12 及以上在 -O2 下就会向量化这样的循环，更早的版本需要 -O3 或者 -ftree-vectorize
+namespace gridkernels {
+
+static constexpr int LANES = 8;
+
+// 所有元素的最大值，空矩阵返回 INT_MIN
+template<typename T>
+int gridMax(GridView<const T> grid) {
+    int ans = INT_MIN;
+    for(int i = 0; i < grid.getRcnt(); i += 1) {
+        const T* row = grid.row(i);
+        const int n = grid.getCcnt();
+
+        int acc[LANES];
+        for(int k = 0; k < LANES; k += 1) acc[k] = INT_MIN;
+        int j = 0;
+        for(; j + LANES <= n; j += LANES) {
+            for(int k = 0; k < LANES; k += 1) {
+                acc[k] = std::max(acc[k], (int)row[j + k]);
+            }
+        }
+        for(int k = 0; k < LANES; k += 1) ans = std::max(ans, acc[k]);
+        for(; j < n; j += 1) ans = std::max(ans, (int)row[j]);
+    }
+    return ans;
+}
+
+// 原地映射每一个元素，func(i, j, v) 返回新的值
+template<typename T, typename Func>
+void gridMapAll(GridView<T> grid, Func&& func) {
+    for(int i = 0; i < grid.getRcnt(); i += 1) {
+        T* row = grid.row(i);
+        for(int j = 0; j < grid.getCcnt(); j += 1) {
+            row[j] = (T)func(i, j, row[j]);
+        }
+    }
+}
+
+// 合并两个相同大小的矩阵，结果写入 out，func(i, j, a, b) 返回新的值
+template<typename T, typename Func>
+void gridCombine(GridView<const T> lhs, GridView<const T> rhs, GridView<T> out, Func&& func) {
+    ASSERT(lhs.getRcnt() == rhs.getRcnt() && lhs.getRcnt() == out.getRcnt());
+    ASSERT(lhs.getCcnt() == rhs.getCcnt() && lhs.getCcnt() == out.getCcnt());
+    for(int i = 0; i < out.getRcnt(); i += 1) {
+        const T* a = lhs.row(i);
+        const T* b = rhs.row(i);
+        T* c = out.row(i);
+        for(int j = 0; j < out.getCcnt(); j += 1) {
+            c[j] = (T)func(i, j, a[j], b[j]);
+        }
+    }
+}
+
+}
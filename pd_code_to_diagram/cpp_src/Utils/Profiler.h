@@ -0,0 +1,113 @@
+#pragma once
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "EnableFlag.h"
+#include "PrecisionTimer.h"
+
+// 分阶段计时，结果以 Chrome trace-event JSON 格式输出（可以在 chrome://tracing 或 Perfetto 中打开）
+// 在编译时引入 -DNO_PROFILE 可以把所有 PROFILE_PHASE 完全去掉
+class Profiler: public EnableFlag<Profiler> {
+public:
+    struct Event {
+        const char* name;
+        double ts_us;   // 相对于 enable 时刻的开始时间（微秒）
+        double dur_us;  // 持续时间（微秒）
+        const char* arg_name; // 可选的整数参数，为空表示没有参数
+        long long arg_value;
+    };
+
+private:
+    inline static PrecisionTimer::TimePoint origin;
+    inline static std::vector<Event> events;
+
+public:
+    static void enable() {
+        setEnabled(true);
+        origin = PrecisionTimer::Clock::now();
+        events.clear();
+        events.reserve(1 << 12);
+    }
+
+    static double nowUs() {
+        return std::chrono::duration<double, std::micro>(PrecisionTimer::Clock::now() - origin).count();
+    }
+
+    static void record(const char* name, double ts_us, double dur_us, const char* arg_name, long long arg_value) {
+        events.push_back(Event{name, ts_us, dur_us, arg_name, arg_value});
+    }
+
+    static const std::vector<Event>& getEvents() {
+        return events;
+    }
+
+    // 所有阶段都是完整事件 ("ph": "X")，嵌套关系由时间区间给出
+    static void writeChromeTrace(const std::string& filename) {
+        std::ofstream fout(filename);
+        if(!fout) {
+            throw std::runtime_error("could not open " + filename + " for writing");
+        }
+        fout << std::fixed << std::setprecision(3);
+        fout << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        for(size_t i = 0; i < events.size(); i += 1) {
+            const auto& e = events[i];
+            fout << (i == 0 ? "\n" : ",\n")
+                 << "{\"name\": \"" << e.name << "\", \"cat\": \"phase\", \"ph\": \"X\""
+                 << ", \"ts\": " << e.ts_us << ", \"dur\": " << e.dur_us
+                 << ", \"pid\": 1, \"tid\": 1";
+            if(e.arg_name != nullptr) {
+                fout << ", \"args\": {\"" << e.arg_name << "\": " << e.arg_value << "}";
+            }
+            fout << "}";
+        }
+        fout << "\n]}\n";
+        if(!fout) {
+            throw std::runtime_error("failed to write trace data");
+        }
+    }
+};
+
+// 在作用域结束时记录一个阶段，异常退出时同样会记录
+class ScopedPhase {
+private:
+    const char* name;
+    const char* arg_name;
+    long long arg_value;
+    double start_us;
+    bool active;
+
+public:
+    explicit ScopedPhase(const char* _name, const char* _arg_name = nullptr, long long _arg_value = 0):
+        name(_name), arg_name(_arg_name), arg_value(_arg_value), start_us(0), active(Profiler::isEnabled()) {
+        if(active) {
+            start_us = Profiler::nowUs();
+        }
+    }
+
+    ~ScopedPhase() {
+        if(active) {
+            Profiler::record(name, start_us, Profiler::nowUs() - start_us, arg_name, arg_value);
+        }
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+
+#ifdef NO_PROFILE
+    #define PROFILE_PHASE(NAME)
+    #define PROFILE_PHASE_ARG(NAME, ARG_NAME, ARG_VALUE)
+#else
+    // 从当前位置到所在作用域结束记为一个阶段
+    #define PROFILE_PHASE(NAME) \
+        ScopedPhase PROFILE_CONCAT(scoped_phase_, __LINE__)(NAME)
+    #define PROFILE_PHASE_ARG(NAME, ARG_NAME, ARG_VALUE) \
+        ScopedPhase PROFILE_CONCAT(scoped_phase_, __LINE__)(NAME, ARG_NAME, (long long)(ARG_VALUE))
+#endif
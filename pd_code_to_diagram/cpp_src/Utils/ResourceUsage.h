@@ -0,0 +1,54 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+// 进程内存占用的查询，用于基准测试以及统计输出
+// 不支持的平台上返回 -1
+class ResourceUsage {
+public:
+    // 重置峰值常驻内存，之后 getPeakRssKb 只统计重置之后的峰值
+    // 只有 Linux 支持（写入 /proc/self/clear_refs），其他平台上峰值从进程启动开始计算
+    static bool resetPeakRss() {
+#if defined(__linux__)
+        std::ofstream fout("/proc/self/clear_refs");
+        if(!fout) return false;
+        fout << "5";
+        fout.flush();
+        return (bool)fout;
+#else
+        return false;
+#endif
+    }
+
+    // 峰值常驻内存，单位 KB
+    static long long getPeakRssKb() {
+#if defined(__linux__)
+        std::ifstream fin("/proc/self/status");
+        std::string key;
+        while(fin >> key) {
+            if(key == "VmHWM:") {
+                long long kb = -1;
+                fin >> kb;
+                return kb;
+            }
+            std::getline(fin, key);
+        }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+        struct rusage usage;
+        if(getrusage(RUSAGE_SELF, &usage) == 0) {
+    #if defined(__APPLE__)
+            return (long long)usage.ru_maxrss / 1024; // macOS 上的单位是字节
+    #else
+            return (long long)usage.ru_maxrss;
+    #endif
+        }
+#endif
+        return -1;
+    }
+};
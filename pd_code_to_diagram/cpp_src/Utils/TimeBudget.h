@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "Counters.h"
+#include "EnableFlag.h"
+#include "Exceptions.h"
+#include "PrecisionTimer.h"
+
+// 布局的时间预算，超时后在下一个检查点抛出 TimeBudgetExceeded，由调用者干净地结束
+// 检查点：随机种子循环、树形图重试循环、LinkAlgo::buildAll 的每一组边，以及 SPFA 的出队循环
+class TimeBudget: public EnableFlag<TimeBudget> {
+private:
+    // SPFA 每出队这么多次才读一次时钟
+    static constexpr unsigned int POLL_INTERVAL = 256;
+
+    inline static long long budget_ms = 0;
+    inline static PrecisionTimer::TimePoint deadline;
+    inline static unsigned int poll_cnt = 0;
+
+public:
+    // 从现在开始计时
+    static void enable(long long ms) {
+        setEnabled(true);
+        budget_ms = ms;
+        deadline = PrecisionTimer::Clock::now() + std::chrono::milliseconds(ms);
+        poll_cnt = 0;
+    }
+
+    static void disable() {
+        setEnabled(false);
+    }
+
+    static long long getBudgetMs() {
+        return budget_ms;
+    }
+
+    static bool expired() {
+        return isEnabled() && PrecisionTimer::Clock::now() >= deadline;
+    }
+
+    // where 描述检查点的位置，写入异常信息
+    static void check(const char* where) {
+        if(expired()) {
+            COUNTER_ADD(EXC_TIME_BUDGET, 1);
+            THROW_EXCEPTION(TimeBudgetExceeded,
+                "time budget of " + std::to_string(budget_ms) + " ms exceeded in " + where);
+        }
+    }
+
+    // 用于很密集的循环，每 POLL_INTERVAL 次调用才真正检查一次
+    static void poll(const char* where) {
+        if(isEnabled() && ++poll_cnt % POLL_INTERVAL == 0) {
+            check(where);
+        }
+    }
+};
@@ -18,11 +18,16 @@
     #define DEBUG (0)
 #endif
 
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "BorderDetect/BorderDetect.h"
+#include "DiagramDecode/CrossingMetadata.h"
+#include "DiagramDecode/DiagramToPdCode.h"
+#include "DiagramDecode/LayoutVerifier.h"
+#include "Generate/PdCodeGenerator.h"
 #include "LinkAlgo.h"
 #include "NodeSet3D/GenNodeSetAlgo.h"
 #include "PDTreeAlgo/PDCode.h"
@@ -30,19 +35,89 @@
 #include "PDTreeAlgo/SocketInfo.h"
 #include "PdToDiagram2d.h"
 #include "PathEngine/Common/GetBorderSet.h"
+#include "PathEngine/Common/GraphWorkload.h"
+#include "PathEngine/PathAlgorithm/SearchHeatmap.h"
+#include "Render/DiagramRenderer.h"
+#include "Render/SvgRenderer.h"
+#include "Render/TileCodes.h"
+#include "Utils/AllocHooks.h"
+#include "Utils/AllocStats.h"
+#include "Utils/AttemptLog.h"
+#include "Utils/Counters.h"
+#include "Utils/Profiler.h"
+#include "Utils/ResourceUsage.h"
 #include "Utils/StringStream.h"
 
+// 需要写入文件的图片输出
+// 文件名为空字符串表示不输出对应格式
+struct ImageOutput {
+    std::string png_file;
+    std::string ppm_file;
+    std::string svg_file; // "-" 表示输出到标准输出
+    std::string tiles_file; // 每个格子的贴图编号，"-" 表示在其他输出之后追加一行 JSON 到标准输出
+    int  tile_size   = DiagramRenderer::DEFAULT_TILE_SIZE;
+    bool show_labels = false; // 是否在图片上标注 socket 编号
+
+    bool empty() const {
+        return png_file.empty() && ppm_file.empty();
+    }
+
+    // 把一个二维布局矩阵渲染到所有指定的文件中
+    void write(const AbstractIntMatrix2& aim) const {
+        DiagramRenderer renderer(tile_size, show_labels);
+        if(!png_file.empty()) {
+            renderer.renderToPng(aim, png_file);
+        }
+        if(!ppm_file.empty()) {
+            renderer.renderToPpm(aim, ppm_file);
+        }
+    }
+
+    // SVG 直接由布线得到的线段生成，不需要二维布局矩阵
+    void writeSvg(const LinkAlgo& link_algo) const {
+        if(svg_file.empty()) return;
+        SvgRenderer renderer(tile_size, show_labels);
+        if(svg_file == "-") {
+            renderer.render(std::cout, link_algo.getAllEdges(), link_algo.getAllCrossings());
+            return;
+        }
+        std::ofstream fout(svg_file);
+        if(!fout) {
+            throw std::runtime_error("can not open file " + svg_file);
+        }
+        renderer.render(fout, link_algo.getAllEdges(), link_algo.getAllCrossings());
+    }
+};
+
+// 把一行 JSON 写入文件，"-" 表示写到标准输出
+void writeJsonLine(const std::string& file, const std::string& json) {
+    if(file == "-") {
+        std::cout << json << std::endl;
+        return;
+    }
+    std::ofstream fout(file);
+    if(!fout) {
+        throw std::runtime_error("can not open file " + file);
+    }
+    fout << json << std::endl;
+}
+
 // 从 stringstream 读入一个 pd_code
 // 然后试图构建二维布局或者三维布局
 // 如果失败会抛出异常
-void try_many_times(unsigned int min_seed, int last_socket_id, std::stringstream& ss, 
+// 返回值表示布局是否通过了一致性检查（没有要求检查时总是 true）
+bool try_many_times(unsigned int min_seed, int last_socket_id, std::stringstream& ss, 
     int max_try,
     bool show_diagram,   // 是否显示二维布局图
     bool show_serial,    // 是否显示三位空间信息序列化表示
     bool with_zero,      // 输出二维布局图时是否使用零作为空位占位符
     bool show_border,    // 仅仅输出在边界上的所有 socket_id
     bool components,     // 输出所有联通分支相关信息
-    bool test_all_border // 测试所有构型
+    bool test_all_border, // 测试所有构型
+    const ImageOutput& image_output, // 需要写入文件的图片
+    bool verify,         // 检查布局是否与输入的 pd_code 一致
+    const std::string& metadata_file, // 交叉点定向信息的输出文件，空字符串表示不输出
+    const std::string& binary_file    // 二进制布局矩阵的输出文件，空字符串表示不输出
 ) {
 
     // 先计算二维布局
@@ -55,7 +130,7 @@ void try_many_times(unsigned int min_seed, int last_socket_id, std::stringstream
         auto all_cc = pdToDiagram2d.getAllCc(ss);
         REWIND_STRING_STREAM(ss); // 用后复原
         std::cout << detector.jsonifyAllCc(all_cc);
-        return;
+        return true;
     }
 
     // 需要检查的所有
@@ -64,15 +139,17 @@ void try_many_times(unsigned int min_seed, int last_socket_id, std::stringstream
         last_socket_set.push_back(last_socket_id);
     }else {
         auto all_cc = pdToDiagram2d.getAllCc(ss);
-        for(auto cc: all_cc) {
-            if(cc.size()) {
-                last_socket_set.push_back(*cc.begin());
-            }
+        for(int k = 0; k < all_cc.getComponentCnt(); k += 1) {
+            last_socket_set.push_back(*all_cc.begin(k)); // 连通分支中的最小编号
         }
     }
 
+    // 只有下面这些输出会用到二维布局矩阵，其他输出（例如 --border）直接使用线段图
+    bool need_matrix = show_diagram || !image_output.empty() || !binary_file.empty()
+        || (DEBUG && !image_output.tiles_file.empty());
+
     // 计算中间结果
-    std::vector<std::tuple<IntMatrix, GenNodeSetAlgo, GetBorderSet>> calc_ans;
+    std::vector<std::tuple<IntMatrix, GenNodeSetAlgo, LinkAlgo>> calc_ans;
 
     // 计算所有可能外围设定对应的
     int suc_cnt   = 0;
@@ -89,13 +166,16 @@ void try_many_times(unsigned int min_seed, int last_socket_id, std::stringstream
                 + " / " + std::to_string(total_cnt));
         }
         try {
-            auto [link_algo, im] = pdToDiagram2d.convert(min_seed, last_socket_id_now, ss, max_try);
+            auto [link_algo, im] = pdToDiagram2d.convert(min_seed, last_socket_id_now, ss, max_try, nullptr, need_matrix);
 
-            GenNodeSetAlgo gen_node_set_algo(link_algo.getFinalGraph(), link_algo.getAllEdges());
-            GetBorderSet gbs(im);
+            auto gen_node_set_algo = [&]() {
+                PROFILE_PHASE("gen_node_set");
+                ALLOC_SCOPE(OUTPUT);
+                return GenNodeSetAlgo(link_algo.getFinalGraph(), link_algo.getAllEdges());
+            }();
 
             // 记录中间答案
-            calc_ans.push_back(std::make_tuple(im, gen_node_set_algo, gbs));
+            calc_ans.push_back(std::make_tuple(std::move(im), gen_node_set_algo, link_algo));
             suc_cnt += 1;
 
         }
@@ -108,29 +188,92 @@ void try_many_times(unsigned int min_seed, int last_socket_id, std::stringstream
     }
 
     if(calc_ans.empty()) {
+        COUNTER_ADD(EXC_MAX_TRY, 1);
         THROW_EXCEPTION(MaxTryExceeded, "no requested layout succeeded");
     }
     
     // 针对非测试状态编写的代码
     {
         SHOW_DEBUG_MESSAGE("output ans ...");
-        auto [im, gen_node_set_algo, gbs] = calc_ans[0];
+        PROFILE_PHASE("output");
+        ALLOC_SCOPE(OUTPUT);
+        auto& [im, gen_node_set_algo, link_algo] = calc_ans[0];
+
+        // 图片直接写入文件，不影响标准输出上的其他内容
+        if(!image_output.empty()) {
+            image_output.write(im.view());
+        }
+        if(!binary_file.empty()) {
+            std::ofstream fout(binary_file, std::ios::binary);
+            if(!fout) {
+                throw std::runtime_error("could not open " + binary_file + " for writing");
+            }
+            im.binaryOutput(fout);
+        }
+        image_output.writeSvg(link_algo);
+
+        // 检查结果输出到标准错误，不影响标准输出上的布局图
+        bool verified = true;
+        if(verify) {
+            PDCode pd_code;
+            REWIND_STRING_STREAM(ss);
+            if(!pd_code.InputPdCode(ss)) {
+                throw std::invalid_argument("invalid PD code");
+            }
+            REWIND_STRING_STREAM(ss);
+
+            std::string reason;
+            verified = LayoutVerifier::verify(link_algo.getFinalGraph(), pd_code, reason);
+            if(verified) {
+                std::cerr << "verify: ok" << std::endl;
+            }else {
+                std::cerr << "verify: failed: " << reason << std::endl;
+            }
+        }
 
         if(show_diagram) {
             im.debugOutput(std::cout, with_zero); // 输出二维布局图
-            return;
-        }
-        if(show_serial) {
+        }else if(show_serial) {
             gen_node_set_algo.outputGraph(std::cout); // 输出三维点坐标情况
-            return;
+        }else if(show_border) { // 仅仅输出边界信息
+            GetBorderSet gbs(link_algo.getAllEdges(), link_algo.getFinalGraph()); // 在线段图上计算，不需要扫描矩阵
+            gbs.debugOutput(std::cout);
         }
-        if(show_border) { // 仅仅输出边界信息
-            gbs.debugOutput(std::cout); // 仅仅输出边界信息
-            return;
+
+        // 交叉点定向信息与贴图编号，"-" 表示在其他输出之后追加一行 JSON 到标准输出
+        if(!metadata_file.empty()) {
+            writeJsonLine(metadata_file, CrossingMetadata(link_algo).jsonify());
+        }
+        if(!image_output.tiles_file.empty()) {
+            TileCodes tile_codes(link_algo);
+            if(DEBUG) {
+                auto aim = im.view();
+                for(int i = 0; i < aim.getRcnt(); i += 1) {
+                    for(int j = 0; j < aim.getCcnt(); j += 1) {
+                        ASSERT(tile_codes.getCode(i, j) == DiagramRenderer::tileCodeForCell(aim, i, j));
+                    }
+                }
+            }
+            writeJsonLine(image_output.tiles_file, tile_codes.jsonify());
         }
+        return verified;
     }
 }
 
+// 把命令行参数值转换为对应类型，转换失败时返回 false
+bool parseArgumentValue(const std::string& text, std::string& value) {
+    value = text;
+    return true;
+}
+
+bool parseArgumentValue(const std::string& text, int& value) {
+    if(!isAllDigits(text) || text.size() > 9) {
+        return false;
+    }
+    value = std::stoi(text);
+    return true;
+}
+
 #ifndef NO_MAIN // 如果 NO_MAIN 标志存在，则不编译 main 函数
 int main(int argc, char** argv) {
 
@@ -147,6 +290,23 @@ int main(int argc, char** argv) {
     bool show_border     = false; // 是否要输出边界信息（输出边界信息的话，就不会输出图或者序列化表示）
     bool components      = false; // 是否需要输出所有的联通分支
     bool test_all_border = false; // 测试所有构型
+    bool input_diagram   = false; // 标准输入中给出的是二维布局矩阵而不是 pd_code
+    bool from_diagram    = false; // 从标准输入中的二维布局矩阵还原 pd_code
+    bool verify          = false; // 检查布局是否与输入的 pd_code 一致，不一致时返回 3
+    ImageOutput image_output;     // 需要输出的图片文件
+    std::string metadata_file;    // 交叉点定向信息的输出文件
+    std::string binary_file;      // 二进制布局矩阵的输出文件
+    std::string profile_file;     // 分阶段计时的输出文件（Chrome trace-event JSON）
+    std::string stats_file;       // 热点计数器的输出文件，"-" 表示在其他输出之后追加一行 JSON 到标准输出
+    std::string attempt_log_file; // 每个随机种子的尝试结果，每个种子一行 JSON，"-" 表示追加到标准输出
+    std::string heatmap_dir;      // 每次最短路搜索的出队次数热力图的输出目录
+    std::string workload_file;    // LinkAlgo 对地图引擎的调用序列的输出文件，用于 Bench/engine_bench.cpp 重放
+    std::string gen_method;       // 不读入标准输入，改为生成随机 PD code：braid、plat 或者 planar
+    int gen_count      = 1;       // 生成的 PD code 个数
+    int gen_crossings  = 10;      // 每个 PD code 的交叉点个数
+    int gen_components = 1;       // 每个 PD code 的连通分支个数
+    int gen_seed       = 0;       // 随机种子，相同的参数与种子总是给出相同的结果
+    int time_budget_ms = -1;      // 布局的时间预算（毫秒），-1 表示不限制，超时时返回 4
 
 // 用于定义所有参数信息
 #define DECLARE_ARGUMENT(LONG_NAME, SHORT_NAME, VAR_NAME) if(( \
@@ -155,6 +315,21 @@ int main(int argc, char** argv) {
     (VAR_NAME) = true; \
 }else
 
+// 用于定义带有一个参数值的参数信息，参数值是紧随其后的下一个命令行参数
+#define DECLARE_VALUE_ARGUMENT(LONG_NAME, VAR_NAME) if( \
+    args[i] == (LONG_NAME) \
+) { \
+    if(i + 1 >= (int)args.size()) { \
+        std::cerr << "error: missing value for command line argument: " << args[i] << std::endl; \
+        return 1; \
+    } \
+    i += 1; \
+    if(!parseArgumentValue(args[i], (VAR_NAME))) { \
+        std::cerr << "error: invalid value for command line argument " << args[i - 1] << ": " << args[i] << std::endl; \
+        return 1; \
+    } \
+}else
+
     // 处理命令行参数
     for(int i = 0; i < args.size(); i += 1) {
         DECLARE_ARGUMENT(    "--diagram", "-d",    show_diagram)
@@ -163,6 +338,28 @@ int main(int argc, char** argv) {
         DECLARE_ARGUMENT(     "--border", "-b",     show_border)
         DECLARE_ARGUMENT( "--components", "-c",      components)
         DECLARE_ARGUMENT(       "--test", "-t", test_all_border)
+        DECLARE_ARGUMENT("--input-diagram", "-i", input_diagram)
+        DECLARE_ARGUMENT( "--from-diagram", "-f",  from_diagram)
+        DECLARE_ARGUMENT(     "--verify", "-v",          verify)
+        DECLARE_ARGUMENT(     "--labels", "-l", image_output.show_labels)
+        DECLARE_VALUE_ARGUMENT(      "--png", image_output.png_file)
+        DECLARE_VALUE_ARGUMENT(      "--ppm", image_output.ppm_file)
+        DECLARE_VALUE_ARGUMENT(      "--svg", image_output.svg_file)
+        DECLARE_VALUE_ARGUMENT("--tile-size", image_output.tile_size)
+        DECLARE_VALUE_ARGUMENT( "--metadata", metadata_file)
+        DECLARE_VALUE_ARGUMENT(    "--tiles", image_output.tiles_file)
+        DECLARE_VALUE_ARGUMENT(   "--binary", binary_file)
+        DECLARE_VALUE_ARGUMENT(  "--profile", profile_file)
+        DECLARE_VALUE_ARGUMENT(    "--stats", stats_file)
+        DECLARE_VALUE_ARGUMENT("--attempt-log", attempt_log_file)
+        DECLARE_VALUE_ARGUMENT(  "--heatmap", heatmap_dir)
+        DECLARE_VALUE_ARGUMENT("--graph-workload", workload_file)
+        DECLARE_VALUE_ARGUMENT( "--generate", gen_method)
+        DECLARE_VALUE_ARGUMENT("--gen-count", gen_count)
+        DECLARE_VALUE_ARGUMENT("--gen-crossings", gen_crossings)
+        DECLARE_VALUE_ARGUMENT("--gen-components", gen_components)
+        DECLARE_VALUE_ARGUMENT( "--gen-seed", gen_seed)
+        DECLARE_VALUE_ARGUMENT("--time-budget-ms", time_budget_ms)
 
         // 数字的情况可以用于设置 last_socket_id
         if(args[i].size() > 2 && args[i].substr(0, 2) == "--" && isAllDigits(args[i].substr(2))) {
@@ -174,19 +371,122 @@ int main(int argc, char** argv) {
     }
 
 #undef DECLARE_ARGUMENT
+#undef DECLARE_VALUE_ARGUMENT
+
+    if(image_output.tile_size <= 0) {
+        std::cerr << "error: --tile-size must be positive" << std::endl;
+        return 1;
+    }
+
+    // 生成随机 PD code，每行一个，格式与标准输入的 pd_code 相同
+    // 参数无法满足时返回 1
+    if(!gen_method.empty()) {
+        GenerateMethod method;
+        if(!PdCodeGenerator::parseMethod(gen_method, method)) {
+            std::cerr << "error: unknown generate method: " << gen_method << std::endl;
+            return 1;
+        }
+        try {
+            PdCodeGenerator generator(method, gen_crossings, gen_components, (unsigned int)gen_seed);
+            std::string out;
+            for(int t = 0; t < gen_count; t += 1) {
+                PdCodeGenerator::appendJson(out, generator.next());
+                out.push_back('\n');
+                if(out.size() >= (1 << 16)) { // 攒够一块再写出
+                    std::cout.write(out.data(), out.size());
+                    out.clear();
+                }
+            }
+            std::cout.write(out.data(), out.size());
+            std::cout.flush();
+        }catch(const std::exception& e) {
+            std::cerr << "error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // 输入本身就是一个二维布局矩阵，此时只能进行渲染或者还原 pd_code
+    // 矩阵不合法时返回 2，以便调用者与其他错误区分
+    if(input_diagram || from_diagram) {
+        if(!image_output.svg_file.empty()) {
+            std::cerr << "error: --svg needs a PD code input, the routed segments are not available" << std::endl;
+            return 1;
+        }
+        try {
+            auto aim = FileDataInput().loadMatrix(std::cin);
+            if(from_diagram) {
+                std::cout << DiagramToPdCode::jsonify(DiagramToPdCode().convert(aim)) << std::endl;
+            }
+            image_output.write(aim);
+            if(!image_output.tiles_file.empty()) {
+                writeJsonLine(image_output.tiles_file, TileCodes(aim).jsonify());
+            }
+        }catch(const BadDiagramException& bde) {
+            std::cerr << "error: " << bde.what() << std::endl;
+            return 2;
+        }
+        return 0;
+    }
+
+    if(!profile_file.empty()) {
+        Profiler::enable();
+    }
+    if(!heatmap_dir.empty()) {
+        SearchHeatmap::enable(heatmap_dir);
+    }
+    if(!workload_file.empty()) {
+        GraphWorkloadRecorder::enable();
+    }
 
     // read in all content in stdin
     auto pd_code_ss = readCinToStringStream();
+    if(time_budget_ms >= 0) { // 预算从读入输入之后开始计算
+        TimeBudget::enable(time_budget_ms);
+    }
     int max_try = 100;
     unsigned int min_seed = 42;
 
+    // 计时与计数的输出，失败时同样写出已经记录的部分
+    auto write_diagnostics = [&]() {
+        if(!profile_file.empty()) {
+            Profiler::writeChromeTrace(profile_file);
+        }
+        if(!stats_file.empty()) {
+            writeJsonLine(stats_file,
+                "{\"stats\": " + Counters::jsonifyCounts()
+                + ", \"outcomes\": " + AttemptLog::jsonifyHistogram()
+                + ", \"memory\": " + AllocStats::jsonify()
+                + ", \"peak_rss_kb\": " + std::to_string(ResourceUsage::getPeakRssKb()) + "}");
+        }
+        if(!attempt_log_file.empty() && !AttemptLog::getRecords().empty()) {
+            writeJsonLine(attempt_log_file, AttemptLog::jsonifyLines());
+        }
+        if(!workload_file.empty()) {
+            GraphWorkloadRecorder::get().save(workload_file);
+        }
+    };
+
     // 尝试给出答案
-    try_many_times(
-        min_seed, 
-        last_socket_id, 
-        pd_code_ss, 
-        max_try, 
-        show_diagram, show_serial, with_zero, show_border, components, test_all_border);
-    return 0;
+    bool verified;
+    try {
+        verified = try_many_times(
+            min_seed, 
+            last_socket_id, 
+            pd_code_ss, 
+            max_try, 
+            show_diagram, show_serial, with_zero, show_border, components, test_all_border,
+            image_output, verify, metadata_file, binary_file);
+    }catch(const TimeBudgetExceeded&) { // 超时时同样写出已经记录的统计，并在标准错误中给出每种结果的种子个数
+        write_diagnostics();
+        std::cerr << "error: time budget of " << time_budget_ms << " ms exceeded after "
+                  << AttemptLog::getRecords().size() << " seeds: " << AttemptLog::jsonifyHistogram() << std::endl;
+        return 4;
+    }catch(...) {
+        write_diagnostics();
+        throw;
+    }
+    write_diagnostics();
+    return verified ? 0 : 3;
 }
 #endif
@@ -1,5 +1,10 @@
 from typing import Optional
 
+try:
+    from .compact import CompactDiagram
+except ImportError:  # Direct execution from the package directory.
+    from compact import CompactDiagram
+
 # 由于扭结可能有定向冲突问题
 # 因此需要编写一个从 diagram 到 pd_code 的检查来保证确实是同一个 pd_code
 
@@ -94,6 +99,20 @@ def get_dir(xi:int, xj:int, fi:int, fj:int, in_out:str) -> int:
         raise AssertionError()
     return dir_now
 
+# 长度为 2 的连通分支的两种定向在矩阵中无法区分，约定如下（main.pd_code_diagram_sanity 使用相同的约定）：
+# 分支从下方穿过的交叉点排在前面，相同时按另一条线的两个编号（从小到大）排序，排在最前面的交叉点上较小的编号对应 in
+# 分支在两个交叉点上都从上方穿过时，两种定向得到的 pd_code 相同
+def len_2_crossing_key(diagram:list[list[int]], crossing:tuple[int, int], component_set:set[int]) -> tuple[int, list[int]]:
+    xi, xj = crossing
+    vertical   = [diagram[xi + DX[d]][xj + DY[d]] for d in (1, 3)]
+    horizontal = [diagram[xi + DX[d]][xj + DY[d]] for d in (0, 2)]
+    is_vertical = set(vertical) == component_set
+    other = horizontal if is_vertical else vertical
+
+    # -1 表示竖直方向的线从下方穿过，-2 表示水平方向的线从下方穿过
+    under = diagram[xi][xj] == (-1 if is_vertical else -2)
+    return (0 if under else 1, sorted(other))
+
 def process_len_2_components(
         diagram:list[list[int]], 
         row_cnt:int, col_cnt:int, 
@@ -149,9 +168,9 @@ def process_len_2_components(
             if len(crossings) != 2:
                 raise AssertionError()
             
-            # 给这个二元素集合定序
-            val1 = list(component_set)[0] # 让 val1 对应 in
-            val2 = list(component_set)[1] # val2 对应 out
+            # 给两个交叉点与这个二元素集合定序，见 len_2_crossing_key
+            crossings.sort(key=lambda crossing: len_2_crossing_key(diagram, crossing, component_set))
+            val1, val2 = sorted(component_set) # 让 val1 对应 in，val2 对应 out
 
             for crossing in crossings:
                 xi, xj = crossing
@@ -293,8 +312,37 @@ def _resolve_crossings(
             raise ValueError(f"could not infer orientations at crossings: {positions}")
     return [resolved[position] for position in sorted(resolved)]
 
-# 注意由于 len2 分支有多种合法定向，所以结果可能不唯一
-def diagram_to_pd_code(diagram:list[list[int]], verbose:bool=False) -> list[list[int]]:
+# 直接从引擎输出的交叉点定向信息读出 pd_code，不需要推断方向
+# 如果给出了 diagram，则同时检查 metadata 与 diagram 是否一致
+def pd_code_from_metadata(metadata:dict, diagram:Optional[list[list[int]]]=None) -> list[list[int]]:
+
+    pd_code = []
+    for crossing in metadata["crossings"]:
+        sockets = [int(socket_id) for socket_id in crossing["sockets"]]
+        if len(sockets) != 4:
+            raise ValueError("crossing metadata must list four sockets")
+
+        if diagram is not None:
+            xi, xj = crossing["row"], crossing["col"]
+            base = crossing["base_direction"]
+            if not (1 <= xi < len(diagram) - 1) or not (1 <= xj < len(diagram[xi]) - 1):
+                raise ValueError(f"crossing ({xi},{xj}) is outside of the diagram")
+            if diagram[xi][xj] != crossing["value"] or diagram[xi][xj] not in [-1, -2]:
+                raise ValueError(f"diagram has no matching crossing at ({xi},{xj})")
+            for k in range(4):
+                d = (base + k) % 4
+                if diagram[xi + DX[d]][xj + DY[d]] != sockets[k]:
+                    raise ValueError(f"socket {sockets[k]} does not match the diagram at ({xi},{xj})")
+
+        pd_code.append(sockets)
+    return sorted(pd_code)
+
+# 检查 diagram 的类型以及形状，不合法时抛出 TypeError 或者 ValueError
+def check_diagram_shape(diagram:list[list[int]]) -> None:
+
+    # CompactDiagram 在构造时已经保证是非空的整数矩形
+    if isinstance(diagram, CompactDiagram):
+        return
 
     if not isinstance(diagram, list):
         raise TypeError()
@@ -309,13 +357,9 @@ def diagram_to_pd_code(diagram:list[list[int]], verbose:bool=False) -> list[list
         if len(raw) == 0:
             raise ValueError()
     
-    # 先检查矩阵的形状规则
-    row_cnt = len(diagram)
-    col_cnt = len(diagram[0])
-    crossing_positions = []
-
     # 检查每一行元素个数相同
     # 由于我们只能对 diagram 做检查
+    col_cnt = len(diagram[0])
     # 而 diagram 中所有编号都是数字，因此要求所有元素都是 int
     for i in range(len(diagram)):
         if len(diagram[i]) != col_cnt:
@@ -323,7 +367,16 @@ def diagram_to_pd_code(diagram:list[list[int]], verbose:bool=False) -> list[list
         for j in range(col_cnt):
             if not isinstance(diagram[i][j], int):
                 raise TypeError()
-    
+
+# 注意由于 len2 分支有多种合法定向，所以结果可能不唯一
+def diagram_to_pd_code(diagram:list[list[int]], verbose:bool=False) -> list[list[int]]:
+
+    # 先检查矩阵的形状规则
+    check_diagram_shape(diagram)
+    row_cnt = len(diagram)
+    col_cnt = len(diagram[0])
+    crossing_positions = []
+
     # "" 表示该位置不需要定向或者还没有确定定向
     direction_matrix = [
         ["" for _ in range(col_cnt)]
@@ -6,14 +6,19 @@ import os
 from pathlib import Path
 import shutil
 import subprocess
+import tempfile
 from typing import Optional
 
 try:
     from .run_file import run_program_with_input
-    from .from_diagram import diagram_to_pd_code
+    from .from_diagram import check_diagram_shape, diagram_to_pd_code
+    from .to_image import tile_keys_from_codes
+    from .compact import CompactDiagram
 except ImportError:  # Direct execution from the package directory.
     from run_file import run_program_with_input
-    from from_diagram import diagram_to_pd_code
+    from from_diagram import check_diagram_shape, diagram_to_pd_code
+    from to_image import tile_keys_from_codes
+    from compact import CompactDiagram
 
 
 PACKAGE_DIR = Path(__file__).resolve().parent
@@ -111,12 +116,7 @@ def create_exe_file(force: bool = False) -> tuple[bool, str]:
     return True, f"compiled layout engine: {EXE_FILE}"
 
 
-def get_diagram_from_pd_code(
-    pd_code: list[list[int]], border_val: Optional[int] = None
-) -> list[list[int]]:
-    """Return the routed integer matrix for a validated PD code."""
-
-    normalized = _validate_pd_code(pd_code)
+def _validate_border_val(normalized: list[list[int]], border_val: Optional[int]) -> None:
     if border_val is not None:
         if (
             isinstance(border_val, bool)
@@ -125,19 +125,80 @@ def get_diagram_from_pd_code(
         ):
             raise ValueError("border_val must be an arc label in the PD code")
 
+
+TIME_BUDGET_EXIT_CODE = 4
+LAYOUT_TIMEOUT_SECONDS = 120
+# Time after the budget for the engine to reach a checkpoint and write its output.
+TIME_BUDGET_GRACE_SECONDS = 10
+
+
+def _time_budget_arguments(time_budget_ms: Optional[int]) -> list[str]:
+    if time_budget_ms is None:
+        return []
+    if (
+        isinstance(time_budget_ms, bool)
+        or not isinstance(time_budget_ms, int)
+        or not 0 <= time_budget_ms < 10**9
+    ):
+        raise ValueError("time_budget_ms must be a non-negative integer")
+    return ["--time-budget-ms", str(time_budget_ms)]
+
+
+def _subprocess_timeout(time_budget_ms: Optional[int]) -> float:
+    if time_budget_ms is None:
+        return LAYOUT_TIMEOUT_SECONDS
+    return time_budget_ms / 1000 + TIME_BUDGET_GRACE_SECONDS
+
+
+def _raise_layout_error(stderr: str, return_code: int) -> None:
+    if return_code == TIME_BUDGET_EXIT_CODE:
+        raise TimeoutError(stderr.strip() or "layout time budget exceeded")
+    raise RuntimeError(stderr.strip() or f"layout engine exited {return_code}")
+
+
+def _run_layout(
+    pd_code: list[list[int]],
+    border_val: Optional[int],
+    time_budget_ms: Optional[int],
+    arguments: list[str],
+    accepted_codes: tuple[int, ...] = (0,),
+) -> tuple[str, int]:
+    """Validate the inputs, route ``pd_code`` with ``arguments`` and map errors.
+
+    Returns the engine's stdout and exit status. Exit statuses outside
+    ``accepted_codes`` raise ``TimeoutError`` or ``RuntimeError``. With a
+    time budget the subprocess gets the budget plus a short grace period
+    instead of the fixed timeout.
+    """
+
+    normalized = _validate_pd_code(pd_code)
+    _validate_border_val(normalized, border_val)
+    budget_arguments = _time_budget_arguments(time_budget_ms)
+
     success, message = create_exe_file()
     if not success:
         raise RuntimeError(message)
 
-    arguments = ["--diagram", "--with_zero"]
-    if border_val is not None:
-        arguments.append("--" + str(border_val))
-    stdout, stderr, return_code = run_program_with_input(
-        str(EXE_FILE), arguments, json.dumps(normalized), timeout=120
-    )
-    if return_code != 0:
-        raise RuntimeError(stderr.strip() or f"layout engine exited {return_code}")
-
+    border_arguments = [] if border_val is None else ["--" + str(border_val)]
+    try:
+        stdout, stderr, return_code = run_program_with_input(
+            str(EXE_FILE),
+            [*arguments, *border_arguments, *budget_arguments],
+            json.dumps(normalized),
+            timeout=_subprocess_timeout(time_budget_ms),
+        )
+    except subprocess.TimeoutExpired as exc:
+        if time_budget_ms is None:
+            raise
+        raise TimeoutError(
+            f"layout engine did not stop within {exc.timeout:g} seconds"
+        ) from exc
+    if return_code not in accepted_codes:
+        _raise_layout_error(stderr, return_code)
+    return stdout, return_code
+
+
+def _parse_diagram_output(stdout: str) -> list[list[int]]:
     diagram: list[list[int]] = []
     try:
         for raw_line in stdout.splitlines():
@@ -153,12 +214,304 @@ def get_diagram_from_pd_code(
     return diagram
 
 
+def _parse_diagram_with_json(
+    stdout: str, keys: tuple[str, ...]
+) -> tuple[list[list[int]], dict[str, dict]]:
+    """Split stdout into the matrix and the JSON lines written to ``-``.
+
+    Each JSON line is matched by the one of ``keys`` it has at the top level
+    (``"crossings"`` for ``--metadata``, ``"tiles"`` for ``--tiles``), so
+    several of them can share stdout in any order.
+    """
+
+    matrix_lines: list[str] = []
+    documents: dict[str, dict] = {}
+    for line in stdout.splitlines():
+        if not line.startswith("{"):
+            matrix_lines.append(line)
+            continue
+        try:
+            document = json.loads(line)
+        except ValueError as exc:
+            raise RuntimeError("layout engine returned an invalid JSON line") from exc
+        matched = [key for key in keys if isinstance(document, dict) and key in document]
+        if len(matched) != 1 or matched[0] in documents:
+            raise RuntimeError("layout engine returned an unexpected JSON line")
+        documents[matched[0]] = document
+    for key in keys:
+        if key not in documents:
+            raise RuntimeError(f"layout engine returned no {key!r} JSON line")
+    return _parse_diagram_output("\n".join(matrix_lines)), documents
+
+
+def get_diagram_from_pd_code(
+    pd_code: list[list[int]],
+    border_val: Optional[int] = None,
+    *,
+    compact: bool = False,
+    time_budget_ms: Optional[int] = None,
+) -> list[list[int]] | CompactDiagram:
+    """Return the routed integer matrix for a validated PD code.
+
+    With ``compact=True`` the engine writes the matrix in binary and it is
+    loaded into a ``CompactDiagram`` backed by one flat ``array('h')``,
+    skipping text parsing, per-row lists and boxed ints.
+
+    ``time_budget_ms`` bounds the layout inside the engine. When it runs out
+    the engine stops at its next checkpoint and ``TimeoutError`` is raised
+    with the number of seeds tried per outcome. The other layout functions
+    take the same keyword.
+    """
+
+    if compact:
+        with tempfile.TemporaryDirectory() as tmp:
+            binary_path = Path(tmp) / "diagram.bin"
+            _run_layout(pd_code, border_val, time_budget_ms, ["--binary", str(binary_path)])
+            payload = binary_path.read_bytes()
+        try:
+            return CompactDiagram.from_bytes(payload)
+        except ValueError as exc:
+            raise RuntimeError(f"layout engine returned an invalid matrix: {exc}") from exc
+
+    stdout, _ = _run_layout(pd_code, border_val, time_budget_ms, ["--diagram", "--with_zero"])
+    return _parse_diagram_output(stdout)
+
+
+def get_diagram_with_metadata(
+    pd_code: list[list[int]],
+    border_val: Optional[int] = None,
+    *,
+    time_budget_ms: Optional[int] = None,
+) -> tuple[list[list[int]], dict]:
+    """Return the routed matrix together with per-crossing orientation data.
+
+    The metadata lists every crossing's ``row``, ``col``, matrix ``value``,
+    ``base_direction`` (0 right, 1 up, 2 left, 3 down) and its four
+    ``sockets`` in PD order, so ``from_diagram.pd_code_from_metadata`` can
+    read the PD code back without inferring any directions.
+    """
+
+    stdout, _ = _run_layout(
+        pd_code, border_val, time_budget_ms, ["--diagram", "--with_zero", "--metadata", "-"]
+    )
+    diagram, documents = _parse_diagram_with_json(stdout, ("crossings",))
+    return diagram, documents["crossings"]
+
+
+def get_diagram_with_tiles(
+    pd_code: list[list[int]],
+    border_val: Optional[int] = None,
+    *,
+    time_budget_ms: Optional[int] = None,
+) -> tuple[list[list[int]], list[list[int | str]]]:
+    """Return the routed matrix together with the tile key of every cell.
+
+    The engine derives the keys from the routed segments, so passing them to
+    ``to_image.diagram_to_image(diagram, tile_keys=...)`` skips the per-cell
+    neighbor checks in Python.
+    """
+
+    stdout, _ = _run_layout(
+        pd_code, border_val, time_budget_ms, ["--diagram", "--with_zero", "--tiles", "-"]
+    )
+    diagram, documents = _parse_diagram_with_json(stdout, ("tiles",))
+    try:
+        tile_keys = tile_keys_from_codes(documents["tiles"]["tiles"])
+    except (ValueError, KeyError, TypeError) as exc:
+        raise RuntimeError("layout engine returned invalid tile codes") from exc
+    return diagram, tile_keys
+
+
+def pd_code_layout_verify(
+    pd_code: list[list[int]],
+    border_val: Optional[int] = None,
+    *,
+    time_budget_ms: Optional[int] = None,
+) -> tuple[bool, list[list[int]]]:
+    """Route a PD code and check the layout against it inside the engine.
+
+    The engine traces every arc of the routed layout and compares the
+    rebuilt crossing records with the input. The comparison ignores arc
+    directions, so ``[a, b, c, d]`` matches ``[c, d, a, b]``. Unlike
+    ``pd_code_diagram_sanity``, it does not check the orientation of the
+    decoded PD code. Returns the verdict and the matrix.
+    """
+
+    stdout, return_code = _run_layout(
+        pd_code, border_val, time_budget_ms, ["--diagram", "--with_zero", "--verify"], (0, 3)
+    )
+    return return_code == 0, _parse_diagram_output(stdout)
+
+
+def get_svg_from_pd_code(
+    pd_code: list[list[int]],
+    border_val: Optional[int] = None,
+    *,
+    tile_size: int = 30,
+    show_socket_labels: bool = False,
+    time_budget_ms: Optional[int] = None,
+) -> str:
+    """Return an SVG drawing of the routed layout without using Pillow."""
+
+    if isinstance(tile_size, bool) or not isinstance(tile_size, int) or tile_size <= 0:
+        raise ValueError("tile_size must be a positive integer")
+
+    arguments = ["--svg", "-", "--tile-size", str(tile_size)]
+    if show_socket_labels:
+        arguments.append("--labels")
+    stdout, _ = _run_layout(pd_code, border_val, time_budget_ms, arguments)
+    if not stdout.lstrip().startswith("<svg"):
+        raise RuntimeError("layout engine returned no SVG document")
+    return stdout
+
+
+def _diagram_to_engine_input(diagram: list[list[int]] | CompactDiagram) -> str:
+    if isinstance(diagram, CompactDiagram):
+        return diagram.to_text()
+    return "".join(" ".join(str(value) for value in row) + "\n" for row in diagram)
+
+
+def get_pd_code_from_diagram(
+    diagram: list[list[int]], verbose: bool = False
+) -> list[list[int]]:
+    """Trace a routed matrix back into a sorted PD code.
+
+    The bundled engine does the tracing; the pure Python tracer is used when
+    the engine cannot be built or when verbose tracing output is requested.
+    Invalid or ambiguous matrices raise ``ValueError`` in both cases.
+    """
+
+    check_diagram_shape(diagram)
+    if verbose:
+        return diagram_to_pd_code(diagram, verbose=True)
+    success, _ = create_exe_file()
+    if not success:
+        return diagram_to_pd_code(diagram)
+
+    stdout, stderr, return_code = run_program_with_input(
+        str(EXE_FILE),
+        ["--from-diagram"],
+        _diagram_to_engine_input(diagram),
+        timeout=LAYOUT_TIMEOUT_SECONDS,
+    )
+    if return_code == 2:
+        raise ValueError(stderr.strip())
+    if return_code != 0:
+        raise RuntimeError(stderr.strip() or f"layout engine exited {return_code}")
+    try:
+        return [list(crossing) for crossing in json.loads(stdout)]
+    except ValueError as exc:
+        raise RuntimeError("layout engine returned an invalid PD code") from exc
+
+
+GENERATE_METHODS = ("braid", "plat", "planar")
+
+
+def generate_pd_codes(
+    count: int,
+    crossings: int,
+    *,
+    components: int = 1,
+    method: str = "braid",
+    seed: int = 0,
+) -> list[list[list[int]]]:
+    """Generate random valid PD codes with the native generator.
+
+    ``method`` is ``"braid"`` (random braid closures), ``"plat"`` (random
+    plat closures) or ``"planar"`` (random 4-regular plane graphs with random
+    over/under choices). Every code has exactly ``crossings`` crossings and
+    ``components`` components, and the same arguments always give the same
+    codes. Parameters that cannot be satisfied raise ``ValueError``.
+    """
+
+    if method not in GENERATE_METHODS:
+        raise ValueError(f"method must be one of {', '.join(GENERATE_METHODS)}")
+    for name, value, low in (
+        ("count", count, 0),
+        ("crossings", crossings, 2),
+        ("components", components, 1),
+        ("seed", seed, 0),
+    ):
+        if isinstance(value, bool) or not isinstance(value, int) or not low <= value < 10**9:
+            raise ValueError(f"{name} must be an integer in [{low}, 10**9)")
+    if count == 0:
+        return []
+
+    success, message = create_exe_file()
+    if not success:
+        raise RuntimeError(message)
+
+    arguments = [
+        "--generate", method,
+        "--gen-count", str(count),
+        "--gen-crossings", str(crossings),
+        "--gen-components", str(components),
+        "--gen-seed", str(seed),
+    ]
+    stdout, stderr, return_code = run_program_with_input(
+        str(EXE_FILE), arguments, "", timeout=LAYOUT_TIMEOUT_SECONDS
+    )
+    if return_code == 1:
+        raise ValueError(stderr.strip())
+    if return_code != 0:
+        raise RuntimeError(stderr.strip() or f"layout engine exited {return_code}")
+    return [json.loads(line) for line in stdout.splitlines() if line.strip()]
+
+
+def random_pd_code(
+    crossings: int, *, components: int = 1, method: str = "braid", seed: int = 0
+) -> list[list[int]]:
+    """Generate one random valid PD code, see ``generate_pd_codes``."""
+
+    return generate_pd_codes(1, crossings, components=components, method=method, seed=seed)[0]
+
+
+def render_diagram_with_engine(
+    diagram: list[list[int]],
+    output_path: str | os.PathLike[str],
+    *,
+    tile_size: int = 30,
+    show_socket_labels: bool = False,
+    image_format: str = "png",
+) -> None:
+    """Render a routed matrix to a PNG or PPM file with the native renderer."""
+
+    if image_format not in ("png", "ppm"):
+        raise ValueError("image_format must be 'png' or 'ppm'")
+    success, message = create_exe_file()
+    if not success:
+        raise RuntimeError(message)
+
+    arguments = [
+        "--input-diagram",
+        "--" + image_format,
+        str(Path(output_path)),
+        "--tile-size",
+        str(tile_size),
+    ]
+    if show_socket_labels:
+        arguments.append("--labels")
+    _, stderr, return_code = run_program_with_input(
+        str(EXE_FILE),
+        arguments,
+        _diagram_to_engine_input(diagram),
+        timeout=LAYOUT_TIMEOUT_SECONDS,
+    )
+    if return_code == 2:
+        raise ValueError(stderr.strip())
+    if return_code != 0:
+        raise RuntimeError(stderr.strip() or f"layout engine exited {return_code}")
+
+
 def get_diagram_str_from_pd_code(
-    pd_code: list[list[int]], border_val: Optional[int] = None
+    pd_code: list[list[int]],
+    border_val: Optional[int] = None,
+    *,
+    time_budget_ms: Optional[int] = None,
 ) -> str:
     """Return a whitespace-formatted view of a routed matrix."""
 
-    diagram = get_diagram_from_pd_code(pd_code, border_val)
+    diagram = get_diagram_from_pd_code(pd_code, border_val, time_budget_ms=time_budget_ms)
     width = max(len(str(value)) for row in diagram for value in row) + 1
     return "".join(
         "".join(" " * width if value == 0 else f"{value:{width}d}" for value in row)
@@ -217,8 +570,24 @@ def pd_code_diagram_sanity(
             if real_next[pd_code[index][0]] != pd_code[index][2]:
                 raise ValueError("could not orient PD crossing")
 
+    # Two-arc components follow the convention of from_diagram.len_2_crossing_key:
+    # the smaller label enters the first crossing the component passes under,
+    # ordered by the sorted labels of the other strand.
+    for nodes in node_sets.values():
+        related = [index for index, crossing in enumerate(pd_code) if nodes <= set(crossing)]
+        if len(nodes) != 2 or len(related) != 2:
+            continue
+        under = [index for index in related if {pd_code[index][0], pd_code[index][2]} == nodes]
+        if not under:
+            continue
+        first = min(under, key=lambda index: sorted(pd_code[index][1::2]))
+        if pd_code[first][0] != min(nodes):
+            for index in under:
+                pd_code[index] = pd_code[index][2:4] + pd_code[index][0:2]
+    pd_code.sort()
+
     diagram = get_diagram_from_pd_code(pd_code, *args, **kwargs)
-    recovered = sorted(diagram_to_pd_code(diagram))
+    recovered = sorted(get_pd_code_from_diagram(diagram))
     return pd_code == recovered, recovered
 
 
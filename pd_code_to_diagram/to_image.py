@@ -3,10 +3,17 @@ from __future__ import annotations
 from functools import lru_cache
 from math import cos, radians, sin
 from os import PathLike
+import struct
 from typing import Optional
+import zlib
 
 from PIL import Image, ImageDraw, ImageFont
 
+try:
+    from .compact import CompactDiagram
+except ImportError:  # Direct execution from the package directory.
+    from compact import CompactDiagram
+
 
 DEFAULT_TILE_SIZE = 30
 BASE_LINE_WIDTH = 4
@@ -34,9 +41,23 @@ CROSSING_TILE_SYMBOLS = {
     "n1": ("MT", "MB", "C", "ML", "MR"),
     "n2": ("ML", "MR", "C", "MT", "MB"),
 }
+# One character per cell in the engine's ``--tiles`` output.
+TILE_CODE_KEYS = {
+    "0": EMPTY_TILE,
+    "3": 3,
+    "5": 5,
+    "6": 6,
+    "9": 9,
+    "a": 10,
+    "c": 12,
+    "h": "n1",
+    "v": "n2",
+}
 
 
-def _validate_diagram(diagram: list[list[int]]) -> tuple[int, int]:
+def _validate_diagram(diagram: list[list[int]] | CompactDiagram) -> tuple[int, int]:
+    if isinstance(diagram, CompactDiagram):
+        return diagram.shape
     if not isinstance(diagram, list) or len(diagram) == 0:
         raise ValueError("diagram must be a non-empty list of rows")
 
@@ -226,6 +247,27 @@ def _tile_key_for_cell(
     return mask
 
 
+def tile_keys_from_codes(rows: list[str]) -> list[list[int | str]]:
+    """Decode the engine's per-row tile code strings into tile keys."""
+
+    try:
+        return [[TILE_CODE_KEYS[code] for code in row] for row in rows]
+    except KeyError as exc:
+        raise ValueError(f"unknown tile code {exc.args[0]!r}") from None
+
+
+def _validate_tile_keys(
+    tile_keys: list[list[int | str]], row_cnt: int, col_cnt: int
+) -> None:
+    if len(tile_keys) != row_cnt or any(len(row) != col_cnt for row in tile_keys):
+        raise ValueError("tile_keys must have the same shape as the diagram")
+    valid = set(TILE_CODE_KEYS.values())
+    for row in tile_keys:
+        for key in row:
+            if key not in valid:
+                raise ValueError(f"unknown tile key {key!r}")
+
+
 def _draw_socket_labels(
     image: Image.Image,
     diagram: list[list[int]],
@@ -233,7 +275,15 @@ def _draw_socket_labels(
     col_cnt: int,
     tile_width: int,
     tile_height: int,
+    crossing_rows: Optional[range] = None,
+    y_offset: int = 0,
 ) -> None:
+    """Label the neighbors of the crossings in ``crossing_rows``.
+
+    ``y_offset`` is the canvas row of ``image``'s top edge, so a strip can be
+    labelled on its own; text outside the strip is clipped by Pillow.
+    """
+
     draw = ImageDraw.Draw(image)
     font = _load_label_font(tile_width, tile_height)
     margin = max(2, min(tile_width, tile_height) // 10)
@@ -245,7 +295,9 @@ def _draw_socket_labels(
         (0, -1, 1, 1, "rd"),  # left neighbor: bottom-right
     )
 
-    for i in range(row_cnt):
+    if crossing_rows is None:
+        crossing_rows = range(row_cnt)
+    for i in range(max(0, crossing_rows.start), min(row_cnt, crossing_rows.stop)):
         for j in range(col_cnt):
             if diagram[i][j] not in CROSSING_TILES:
                 continue
@@ -271,7 +323,7 @@ def _draw_socket_labels(
                 else:
                     y -= margin
 
-                draw.text((x, y), str(val), fill=LABEL_COLOR, font=font, anchor=anchor)
+                draw.text((x, y - y_offset), str(val), fill=LABEL_COLOR, font=font, anchor=anchor)
 
 
 def diagram_to_image(
@@ -279,8 +331,17 @@ def diagram_to_image(
     *,
     tile_size: Optional[int] = None,
     show_socket_labels: bool = False,
+    tile_keys: Optional[list[list[int | str]]] = None,
 ) -> Image.Image:
+    """Composite the diagram from cached tiles.
+
+    ``tile_keys`` may carry the per-cell keys computed by the engine (see
+    ``main.get_diagram_with_tiles``); the neighbor checks are then skipped.
+    """
+
     row_cnt, col_cnt = _validate_diagram(diagram)
+    if tile_keys is not None:
+        _validate_tile_keys(tile_keys, row_cnt, col_cnt)
     if tile_size is not None and tile_size <= 0:
         raise ValueError("tile_size must be positive")
     if not isinstance(show_socket_labels, bool):
@@ -293,7 +354,10 @@ def diagram_to_image(
 
     for i in range(row_cnt):
         for j in range(col_cnt):
-            tile_key = _tile_key_for_cell(diagram, row_cnt, col_cnt, i, j)
+            if tile_keys is None:
+                tile_key = _tile_key_for_cell(diagram, row_cnt, col_cnt, i, j)
+            else:
+                tile_key = tile_keys[i][j]
             image.paste(tiles[tile_key], (j * tile_width, i * tile_height))
 
     if show_socket_labels:
@@ -308,7 +372,31 @@ def diagram_to_png(
     *,
     tile_size: Optional[int] = None,
     show_socket_labels: bool = False,
+    use_engine: bool = False,
 ) -> Image.Image:
+    if use_engine:
+        # The native renderer draws straight into an RGB buffer and encodes
+        # the PNG itself, avoiding the per-cell Python loop.
+        try:
+            from .main import render_diagram_with_engine
+        except ImportError:  # Direct execution from the package directory.
+            from main import render_diagram_with_engine
+
+        _validate_diagram(diagram)
+        if tile_size is not None and tile_size <= 0:
+            raise ValueError("tile_size must be positive")
+        if not isinstance(show_socket_labels, bool):
+            raise TypeError("show_socket_labels must be bool")
+        render_diagram_with_engine(
+            diagram,
+            output_path,
+            tile_size=DEFAULT_TILE_SIZE if tile_size is None else tile_size,
+            show_socket_labels=show_socket_labels,
+        )
+        with Image.open(output_path) as image:
+            image.load()
+            return image
+
     image = diagram_to_image(
         diagram,
         tile_size=tile_size,
@@ -316,3 +404,85 @@ def diagram_to_png(
     )
     image.save(output_path, format="PNG")
     return image
+
+
+def _png_chunk(chunk_type: bytes, body: bytes) -> bytes:
+    return (
+        struct.pack(">I", len(body))
+        + chunk_type
+        + body
+        + struct.pack(">I", zlib.crc32(chunk_type + body))
+    )
+
+
+def diagram_to_png_streaming(
+    diagram: list[list[int]],
+    output_path: str | PathLike[str],
+    *,
+    tile_size: Optional[int] = None,
+    show_socket_labels: bool = False,
+    tile_keys: Optional[list[list[int | str]]] = None,
+) -> tuple[int, int]:
+    """Write the PNG one row of tiles at a time and return ``(width, height)``.
+
+    Each strip is composited, labelled, compressed into the IDAT stream and
+    dropped before the next one, so peak memory is one strip instead of the
+    whole canvas. The pixels match ``diagram_to_image``.
+    """
+
+    row_cnt, col_cnt = _validate_diagram(diagram)
+    if tile_keys is not None:
+        _validate_tile_keys(tile_keys, row_cnt, col_cnt)
+    if tile_size is not None and tile_size <= 0:
+        raise ValueError("tile_size must be positive")
+    if not isinstance(show_socket_labels, bool):
+        raise TypeError("show_socket_labels must be bool")
+
+    real_tile_size = DEFAULT_TILE_SIZE if tile_size is None else tile_size
+    tiles = _load_tiles(real_tile_size)
+    tile_width, tile_height = next(iter(tiles.values())).size
+    width = col_cnt * tile_width
+    height = row_cnt * tile_height
+    row_bytes = width * 3
+
+    compressor = zlib.compressobj()
+    with open(output_path, "wb") as output:
+        output.write(b"\x89PNG\r\n\x1a\n")
+        output.write(_png_chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+
+        strip = Image.new("RGB", (width, tile_height), "white")
+        for i in range(row_cnt):
+            for j in range(col_cnt):
+                if tile_keys is None:
+                    tile_key = _tile_key_for_cell(diagram, row_cnt, col_cnt, i, j)
+                else:
+                    tile_key = tile_keys[i][j]
+                strip.paste(tiles[tile_key], (j * tile_width, 0))
+
+            # Labels sit in the cells next to a crossing, so only crossings in
+            # the adjacent rows can reach this strip.
+            if show_socket_labels:
+                _draw_socket_labels(
+                    strip,
+                    diagram,
+                    row_cnt,
+                    col_cnt,
+                    tile_width,
+                    tile_height,
+                    crossing_rows=range(i - 1, i + 2),
+                    y_offset=i * tile_height,
+                )
+
+            pixels = strip.tobytes()
+            scanlines = b"".join(
+                b"\x00" + pixels[y * row_bytes : (y + 1) * row_bytes]
+                for y in range(tile_height)
+            )
+            data = compressor.compress(scanlines)
+            if data:
+                output.write(_png_chunk(b"IDAT", data))
+
+        output.write(_png_chunk(b"IDAT", compressor.flush()))
+        output.write(_png_chunk(b"IEND", b""))
+
+    return width, height
@@ -1,15 +1,45 @@
+import json
 from pathlib import Path
 import subprocess
 import tempfile
 import unittest
+from xml.etree import ElementTree
 from unittest.mock import patch
 
-from pd_code_to_diagram import pd_code_diagram_sanity
+from pd_code_to_diagram import diagram_to_image, diagram_to_png, diagram_to_png_streaming
+from pd_code_to_diagram import get_diagram_from_pd_code, pd_code_diagram_sanity
+from pd_code_to_diagram import get_svg_from_pd_code
 from pd_code_to_diagram import from_diagram
-from pd_code_to_diagram.main import _find_compiler, _validate_pd_code, create_exe_file
+from pd_code_to_diagram import CompactDiagram
+from pd_code_to_diagram import generate_pd_codes
+from pd_code_to_diagram.main import EXE_FILE, _find_compiler, _validate_pd_code, create_exe_file
+from pd_code_to_diagram.main import get_diagram_with_metadata, get_diagram_with_tiles
+from pd_code_to_diagram.main import get_diagram_str_from_pd_code
+from pd_code_to_diagram.main import get_pd_code_from_diagram, pd_code_layout_verify
 
 
 TREFOIL = [[1, 5, 2, 4], [3, 1, 4, 6], [5, 3, 6, 2]]
+# {23, 24} 是只有两段弧、经过两个交叉点的连通分支
+TWO_ARC_LINK = [
+    [22, 16, 1, 15], [7, 24, 8, 23], [21, 14, 22, 15], [23, 6, 24, 7],
+    [13, 20, 14, 21], [5, 13, 6, 12], [4, 11, 5, 12], [10, 20, 11, 19],
+    [18, 10, 19, 9], [8, 3, 9, 4], [17, 2, 18, 3], [16, 2, 17, 1],
+]
+
+
+def _run_engine(*args: str) -> str:
+    """Run the bundled engine on the trefoil and return its stdout."""
+
+    success, message = create_exe_file()
+    if not success:
+        raise RuntimeError(message)
+    return subprocess.run(
+        [str(EXE_FILE), *args],
+        input=json.dumps(TREFOIL),
+        check=True,
+        text=True,
+        stdout=subprocess.PIPE,
+    ).stdout
 
 
 class ValidationTests(unittest.TestCase):
@@ -79,6 +109,218 @@ int main() {
         matches, recovered = pd_code_diagram_sanity(TREFOIL)
         self.assertTrue(matches, recovered)
 
+    def test_native_renderer_matches_python_image_size(self):
+        diagram = get_diagram_from_pd_code(TREFOIL)
+        with tempfile.TemporaryDirectory(prefix="pd_render_") as tmp:
+            output = Path(tmp) / "trefoil.png"
+            native = diagram_to_png(
+                diagram, output, tile_size=12, show_socket_labels=True, use_engine=True
+            )
+            self.assertEqual(output.read_bytes()[:8], b"\x89PNG\r\n\x1a\n")
+        python = diagram_to_image(diagram, tile_size=12)
+        self.assertEqual(native.size, python.size)
+        self.assertEqual(native.getpixel((0, 0)), (255, 255, 255))
+
+    def test_svg_has_one_path_per_arc_and_matches_grid_size(self):
+        diagram = get_diagram_from_pd_code(TREFOIL)
+        svg = get_svg_from_pd_code(TREFOIL, tile_size=12, show_socket_labels=True)
+        root = ElementTree.fromstring(svg)
+        namespace = "{http://www.w3.org/2000/svg}"
+        arcs = sorted(int(path.get("data-arc")) for path in root.iter(namespace + "path"))
+        self.assertEqual(arcs, list(range(1, 7)))
+        self.assertEqual(int(root.get("width")), 12 * len(diagram[0]))
+        self.assertEqual(int(root.get("height")), 12 * len(diagram))
+        self.assertEqual(len(list(root.iter(namespace + "text"))), 12)
+
+    def test_native_decoder_matches_python_decoder(self):
+        diagram = get_diagram_from_pd_code(TREFOIL)
+        self.assertEqual(
+            get_pd_code_from_diagram(diagram), from_diagram.diagram_to_pd_code(diagram)
+        )
+        broken = [row[:] for row in diagram]
+        broken[0][0] = -1
+        with self.assertRaisesRegex(ValueError, "border"):
+            get_pd_code_from_diagram(broken)
+
+    def test_native_decoder_orients_two_arc_components_like_python(self):
+        diagram = get_diagram_from_pd_code(TWO_ARC_LINK)
+        self.assertEqual(
+            get_pd_code_from_diagram(diagram), from_diagram.diagram_to_pd_code(diagram)
+        )
+        self.assertTrue(pd_code_diagram_sanity(TWO_ARC_LINK)[0])
+
+    def test_engine_verification_returns_the_same_diagram(self):
+        passed, diagram = pd_code_layout_verify(TREFOIL)
+        self.assertTrue(passed)
+        self.assertEqual(diagram, get_diagram_from_pd_code(TREFOIL))
+
+    def test_engine_verification_agrees_with_sanity_on_a_link(self):
+        # {1, 2} 是只有两段弧的连通分支，以前 --verify 通过而 pd_code_diagram_sanity 不通过
+        pd_code = [
+            [1, 15, 2, 16], [2, 3, 1, 16], [4, 9, 5, 10], [8, 11, 9, 12],
+            [10, 5, 11, 6], [12, 4, 13, 3], [13, 6, 14, 7], [14, 8, 15, 7],
+        ]
+        self.assertTrue(pd_code_layout_verify(pd_code)[0])
+        self.assertTrue(pd_code_diagram_sanity(pd_code)[0])
+
+    def test_metadata_gives_pd_code_without_inference(self):
+        pd_code = [[2, 1, 3, 2], [1, 3, 4, 4]]
+        diagram, metadata = get_diagram_with_metadata(pd_code)
+        self.assertEqual((metadata["rows"], metadata["cols"]), (len(diagram), len(diagram[0])))
+        self.assertEqual(
+            from_diagram.pd_code_from_metadata(metadata, diagram), sorted(pd_code)
+        )
+
+    def test_engine_tile_keys_match_python_neighbor_logic(self):
+        from pd_code_to_diagram import to_image
+
+        diagram, tile_keys = get_diagram_with_tiles(TREFOIL)
+        rows, cols = len(diagram), len(diagram[0])
+        expected = [
+            [to_image._tile_key_for_cell(diagram, rows, cols, i, j) for j in range(cols)]
+            for i in range(rows)
+        ]
+        self.assertEqual(tile_keys, expected)
+        self.assertEqual(
+            diagram_to_image(diagram, tile_size=8, tile_keys=tile_keys).tobytes(),
+            diagram_to_image(diagram, tile_size=8).tobytes(),
+        )
+
+    def test_streaming_png_matches_full_canvas(self):
+        from PIL import Image
+
+        diagram = get_diagram_from_pd_code(TREFOIL)
+        expected = diagram_to_image(diagram, tile_size=12, show_socket_labels=True)
+        with tempfile.TemporaryDirectory() as tmp:
+            path = Path(tmp) / "strips.png"
+            size = diagram_to_png_streaming(
+                diagram, path, tile_size=12, show_socket_labels=True
+            )
+            with Image.open(path) as image:
+                self.assertEqual(size, image.size)
+                self.assertEqual(image.convert("RGB").tobytes(), expected.tobytes())
+
+    def test_compact_diagram_matches_nested_lists(self):
+        diagram = get_diagram_from_pd_code(TREFOIL)
+        compact = get_diagram_from_pd_code(TREFOIL, compact=True)
+        self.assertIsInstance(compact, CompactDiagram)
+        self.assertEqual(compact.tolist(), diagram)
+        self.assertEqual([list(row) for row in compact], diagram)
+        self.assertEqual(compact.view().shape, (len(diagram), len(diagram[0])))
+        self.assertEqual(compact[1][2], diagram[1][2])
+        self.assertEqual(
+            diagram_to_image(compact, tile_size=8).tobytes(),
+            diagram_to_image(diagram, tile_size=8).tobytes(),
+        )
+        self.assertEqual(
+            get_pd_code_from_diagram(compact), from_diagram.diagram_to_pd_code(compact)
+        )
+
+    def test_profile_writes_chrome_trace_phases(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            trace = Path(tmp) / "trace.json"
+            _run_engine("--diagram", "--profile", str(trace))
+            events = json.loads(trace.read_text())["traceEvents"]
+        names = {event["name"] for event in events}
+        self.assertTrue({"parse_pd_code", "pd_tree", "route", "export_matrix", "output"} <= names)
+        self.assertTrue(all(event["ph"] == "X" and event["dur"] >= 0 for event in events))
+
+    def test_stats_counts_hot_path_events(self):
+        stats = json.loads(_run_engine("--stats", "-").strip().splitlines()[-1])["stats"]
+        self.assertEqual(stats["seeds_tried"], 1)
+        self.assertGreater(stats["spfa_pop"], 0)
+        self.assertGreaterEqual(stats["spfa_relax"], stats["spfa_pop"])
+        self.assertGreater(stats["commit_cells"], 0)
+
+    def test_attempt_log_matches_outcome_histogram(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            log = Path(tmp) / "attempts.jsonl"
+            stdout = _run_engine("--diagram", "--attempt-log", str(log), "--stats", "-")
+            attempts = [json.loads(line)["attempt"] for line in log.read_text().splitlines()]
+        outcomes = json.loads(stdout.strip().splitlines()[-1])["outcomes"]
+        self.assertEqual(attempts[-1]["outcome"], "success")
+        self.assertEqual((attempts[-1]["rows"], attempts[-1]["cols"]), (11, 11))
+        self.assertEqual(sum(entry["count"] for entry in outcomes.values()), len(attempts))
+        self.assertEqual(outcomes["success"]["count"], 1)
+
+    def test_heatmap_writes_one_pgm_per_search_aligned_to_bounds(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            heatmap = Path(tmp) / "heatmap"
+            _run_engine("--heatmap", str(heatmap))
+            entries = [json.loads(line) for line in (heatmap / "index.jsonl").read_text().splitlines()]
+            self.assertTrue(entries)
+            for entry in entries:
+                header = (heatmap / entry["file"]).read_bytes().split(b"\n", 3)
+                self.assertEqual(header[0], b"P5")
+                self.assertEqual(
+                    header[1].split(),
+                    [str(entry["ymax"] - entry["ymin"] + 1).encode(), str(entry["xmax"] - entry["xmin"] + 1).encode()],
+                )
+                self.assertEqual(int(header[2]), max(1, entry["max_pops"]))
+                self.assertTrue((heatmap / entry["obstacles"]).exists())
+                self.assertGreater(entry["pops"], 0)
+
+    def test_stats_attributes_heap_use_to_scopes(self):
+        memory = json.loads(_run_engine("--stats", "-").strip().splitlines()[-1])["memory"]
+        by_scope = memory["by_scope"]
+        self.assertEqual(set(by_scope), {"other", "tree", "routing", "compaction", "border", "output"})
+        self.assertEqual(memory["total_bytes"], sum(scope["bytes"] for scope in by_scope.values()))
+        self.assertEqual(memory["allocations"], sum(scope["allocations"] for scope in by_scope.values()))
+        self.assertGreater(by_scope["routing"]["bytes"], 0)
+        self.assertLessEqual(by_scope["routing"]["peak_live_bytes"], memory["peak_live_bytes"])
+
+    def test_generated_pd_codes_are_valid_and_deterministic(self):
+        for method in ("braid", "plat", "planar"):
+            codes = generate_pd_codes(50, 12, components=2, method=method, seed=4)
+            self.assertEqual(len(codes), 50)
+            for pd_code in codes:
+                self.assertEqual(len(_validate_pd_code(pd_code)), 12)
+            self.assertEqual(codes, generate_pd_codes(50, 12, components=2, method=method, seed=4))
+            self.assertTrue(pd_code_layout_verify(codes[0])[0])
+        with self.assertRaises(ValueError):
+            generate_pd_codes(1, 3, components=3, method="braid")
+        self.assertEqual(len(generate_pd_codes(1, 4, method="plat")[0]), 4)
+        with self.assertRaisesRegex(ValueError, "prime, so 3 components need at least 6 crossings"):
+            generate_pd_codes(1, 4, components=3, method="planar")
+
+    def test_time_budget_stops_layout_with_timeout_error(self):
+        pd_code = generate_pd_codes(1, 120, seed=3)[0]
+        with self.assertRaisesRegex(TimeoutError, "exceeded after 1 seeds.*\"timeout\": \\{\"count\": 1"):
+            get_diagram_from_pd_code(pd_code, time_budget_ms=20)
+        self.assertEqual(get_diagram_from_pd_code(TREFOIL, time_budget_ms=60000), get_diagram_from_pd_code(TREFOIL))
+        with self.assertRaises(TimeoutError):
+            get_diagram_str_from_pd_code(pd_code, time_budget_ms=20)
+        expired = subprocess.TimeoutExpired("engine", 10.02)
+        with patch("pd_code_to_diagram.main.run_program_with_input", side_effect=expired) as run:
+            with self.assertRaisesRegex(TimeoutError, "did not stop within 10.02 seconds"):
+                get_diagram_from_pd_code(TREFOIL, time_budget_ms=20)
+        self.assertEqual(run.call_args.kwargs["timeout"], 10.02)
+
+    def test_recorded_graph_workload_replays_identically_on_every_engine(self):
+        source_root = Path(__file__).resolve().parents[1] / "pd_code_to_diagram" / "cpp_src"
+        with tempfile.TemporaryDirectory() as tmp:
+            workload = Path(tmp) / "trefoil.gwl"
+            _run_engine("--graph-workload", str(workload))
+            executable = Path(tmp) / "engine_bench.exe"
+            subprocess.run(
+                [_find_compiler(), "-std=c++17", str(source_root / "Bench" / "engine_bench.cpp"), "-o", str(executable)],
+                check=True,
+                text=True,
+            )
+            result = subprocess.run(
+                [str(executable), "--workload", str(workload), "--repeat", "1"],
+                check=True,
+                text=True,
+                stdout=subprocess.PIPE,
+            )
+        lines = [json.loads(line) for line in result.stdout.splitlines()]
+        self.assertEqual(lines[-1]["workload"], "trefoil")
+        self.assertTrue(lines[-1]["ok"])
+        self.assertEqual(lines[-1]["backends"], 2)
+        margin = [line for line in lines[:-1] if (line["op"], line["engine"]) == ("get_pos", "margin")]
+        self.assertEqual(len(margin), 2)
+        self.assertGreater(margin[0]["ops"], 0)
+        self.assertEqual(margin[0]["checksum"], margin[1]["checksum"])
 
 if __name__ == "__main__":
     unittest.main()